@@ -0,0 +1,91 @@
+
+// Benchmark of Cave::clear() (a new layout of the bats, the pits, the Wumpus, and the player):
+// calls/s with the Xoshiro256 of the Cave, with an engine given from outside, and with the way
+// clear() was before (a default_random_engine seeded by the clock at each call, std::shuffle(),
+// and rand_int(), which makes a random_device at each call). It also counts how many of the
+// old calls got the same seed as the call before, i.e. the same layout.
+// usage: ./bench_cave [calls]
+
+#include "./std_lib_facilities.h"
+#include "cave.h"
+#include<chrono>
+#include<algorithm>
+
+double seconds_since(chrono::steady_clock::time_point t0){
+  return chrono::duration<double>(chrono::steady_clock::now()-t0).count();
+}
+
+// the old Cave::clear(), without the Cave. Returns the seed it used
+struct Old_clear {
+  int index_perm[20];
+  int bat_rn[2], pit_rn[2], wumpus_rn, player_rn;
+
+  unsigned operator()(){
+    for(int i=1; i<21; ++i)
+      index_perm[i-1] = i;
+    unsigned seed = std::chrono::system_clock::now().time_since_epoch().count();
+    shuffle(index_perm, index_perm+20, default_random_engine(seed));
+    bat_rn[0] = index_perm[0], bat_rn[1] = index_perm[1];
+    pit_rn[0] = index_perm[2], pit_rn[1] = index_perm[3];
+    wumpus_rn = rand_int(1,20);
+    player_rn = index_perm[4] == wumpus_rn ? index_perm[5] : index_perm[4];
+    return seed;
+  }
+};
+
+int main(int argc, char* argv[])
+  try{
+    long calls{argc>1 ? stol(argv[1]) : 2000000};
+    long sum{0};		// of the player's Rooms, so that the calls are not optimized away
+    auto report = [&](const string& label, double sec){
+      cout << label << ": " << calls/sec/1e6 << "M calls/s (" << sec/calls*1e9 << " ns per call)\n";
+    };
+
+    Cave cave{1};
+    auto t0 = chrono::steady_clock::now();
+    for(long i=0; i<calls; ++i)
+      sum += cave.clear();
+    report("clear(), own Xoshiro256     ", seconds_since(t0));
+
+    Xoshiro256 engine{1};
+    Cave outer{engine};
+    t0 = chrono::steady_clock::now();
+    for(long i=0; i<calls; ++i)
+      sum += outer.clear();
+    report("clear(), injected Xoshiro256", seconds_since(t0));
+
+    // the same seed gives the same layouts, whether the engine is the Cave's or not
+    Cave a{7};
+    Xoshiro256 e7{7};
+    Cave b{e7};
+    for(int i=0; i<1000; ++i)
+      if(a.clear() != b.clear())
+	error("the same seed gave different caves");
+
+    Old_clear old;
+    long same_seed{0};
+    unsigned last{0};
+    long old_calls{calls/10};	// it is much slower
+    t0 = chrono::steady_clock::now();
+    for(long i=0; i<old_calls; ++i){
+      unsigned s{old()};
+      same_seed += s == last;
+      last = s;
+      sum += old.player_rn;
+    }
+    double sec{seconds_since(t0)};
+    cout << "the old clear() (clock seed)  : " << old_calls/sec/1e6 << "M calls/s ("
+	 << sec/old_calls*1e9 << " ns per call), " << same_seed << " of " << old_calls
+	 << " calls had the seed of the call before\n";
+
+    cout << "(sum " << sum << ")\n";
+    return 0;
+  }
+  catch(exception& e){
+    cerr << e.what() << endl;
+    return 1;
+  }
+  catch(...){
+    cerr << "Unknown error happens\n";
+    return 1;
+  }
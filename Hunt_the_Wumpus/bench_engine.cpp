@@ -0,0 +1,45 @@
+
+// Benchmark of the headless engine (wumpus_engine.h): turns/s and games/s of play_games() with
+// Random_policy and Smell_policy on 1 thread, with the results of the games (the same seed
+// gives the same numbers).
+// usage: ./bench_engine [games] [seed]
+
+#include "./std_lib_facilities.h"
+#include "wumpus_engine.h"
+#include<chrono>
+
+double seconds_since(chrono::steady_clock::time_point t0){
+  return chrono::duration<double>(chrono::steady_clock::now()-t0).count();
+}
+
+template<typename Policy>
+void bench(const string& label, uint64_t games, unsigned seed, Policy policy){
+  Wumpus_engine e{seed};
+  auto t0 = chrono::steady_clock::now();
+  Game_stats st{play_games(e, games, policy)};
+  double sec{seconds_since(t0)};
+  cout << label << ": " << st.turns/sec/1e6 << "M turns/s, " << st.games/sec/1e6
+       << "M games/s (" << st.turns_per_game() << " turns per game)\n"
+       << "  won " << 100*st.win_rate() << "%, pit " << st.lost(Cause::pit) << ", wumpus "
+       << st.lost(Cause::wumpus) << ", startled wumpus " << st.lost(Cause::startled_wumpus)
+       << ", own arrow " << st.lost(Cause::own_arrow) << ", no arrows "
+       << st.lost(Cause::no_arrows) << ", unfinished " << st.unfinished << '\n';
+}
+
+int main(int argc, char* argv[])
+  try{
+    uint64_t games{argc>1 ? stoull(argv[1]) : 1000000};
+    unsigned seed{argc>2 ? static_cast<unsigned>(stoul(argv[2])) : 1};
+    cout << games << " games, seed " << seed << '\n';
+    bench("Random_policy", games, seed, Random_policy{});
+    bench("Smell_policy ", games, seed, Smell_policy{});
+    return 0;
+  }
+  catch(exception& e){
+    cerr << e.what() << endl;
+    return 1;
+  }
+  catch(...){
+    cerr << "Unknown error happens\n";
+    return 1;
+  }
@@ -0,0 +1,65 @@
+
+// Benchmark of run_games() (monte_carlo.h): games/s of Smell_policy on 1, 2, 4, 8 threads (and
+// on all the cores), the speedup over 1 thread, and a check that every number of threads gives
+// exactly the same results.
+// usage: ./bench_monte_carlo [games] [seed]
+// The speedup can't be more than the number of the cores of the machine.
+
+#include "./std_lib_facilities.h"
+#include "monte_carlo.h"
+#include<chrono>
+
+double seconds_since(chrono::steady_clock::time_point t0){
+  return chrono::duration<double>(chrono::steady_clock::now()-t0).count();
+}
+
+bool same(const Game_stats& a, const Game_stats& b){
+  if(a.games != b.games || a.wins != b.wins || a.turns != b.turns || a.unfinished != b.unfinished)
+    return false;
+  for(int c=0; c<static_cast<int>(Cause::count); ++c)
+    if(a.losses[c] != b.losses[c])
+      return false;
+  return true;
+}
+
+int main(int argc, char* argv[])
+  try{
+    uint64_t games{argc>1 ? stoull(argv[1]) : 4000000};
+    uint64_t seed{argc>2 ? stoull(argv[2]) : 1};
+    int cores{static_cast<int>(thread::hardware_concurrency())};
+    cout << games << " games of Smell_policy, seed " << seed << ", " << cores << " cores\n";
+
+    vector<int> counts{1, 2, 4, 8};
+    if(cores > 8)
+      counts.push_back(cores);
+    Game_stats first;
+    double first_sec{0};
+    for(int threads : counts){
+      auto t0 = chrono::steady_clock::now();
+      Game_stats st{run_games(games, Smell_policy{}, seed, threads)};
+      double sec{seconds_since(t0)};
+      if(threads == 1){
+	first = st;
+	first_sec = sec;
+      }
+      else if(!same(st, first))
+	error("run_games() gave different results on " + to_string(threads) + " threads");
+      cout << threads << " thread" << (threads>1 ? "s" : " ") << ": " << st.games/sec/1e6
+	   << "M games/s, " << st.turns/sec/1e6 << "M turns/s, speedup " << first_sec/sec << '\n';
+    }
+    cout << "won " << 100*first.win_rate() << "%, " << first.turns_per_game()
+	 << " turns per game; lost by pit " << first.lost(Cause::pit) << ", wumpus "
+	 << first.lost(Cause::wumpus) << ", startled wumpus " << first.lost(Cause::startled_wumpus)
+	 << ", own arrow " << first.lost(Cause::own_arrow) << ", no arrows "
+	 << first.lost(Cause::no_arrows) << ", unfinished " << first.unfinished
+	 << " (the same on every number of threads)\n";
+    return 0;
+  }
+  catch(exception& e){
+    cerr << e.what() << endl;
+    return 1;
+  }
+  catch(...){
+    cerr << "Unknown error happens\n";
+    return 1;
+  }
@@ -0,0 +1,443 @@
+
+#ifndef CAVE_GUARD
+#define CAVE_GUARD 1
+
+#include "./std_lib_facilities.h"
+#include "random_engine.h"
+#include <chrono>       // std::chrono::system_clock for random engine seed in Ex 12
+
+// Cave was in main.cpp. I moved it here so that the headless engine (wumpus_engine.h) and the
+// benchmark can use it as well. Cave itself prints nothing except in print() and
+// notify_dangers(): what happened in a move is reported to the caller (Move_report), and the
+// caller (HW_game) tells the player.
+//
+// Where the bats, the pits, and the Wumpus are, and which Rooms are adjacent, are also kept as
+// bitboards: a uint32_t whose bit rn is Room rn (bit 0 is not used). Then "is there a pit next
+// to Room rn" is 1 and of 2 masks, rather than comparing each of the 3 adjacent Rooms with each
+// pit, and checking a move or an arrow is 1 bit of the mask of the Room. Compiling with
+// -DCAVE_ROOM_STRUCTS (make bench LAYOUT=-DCAVE_ROOM_STRUCTS) uses the Room structs and the
+// room #s instead, as before, to compare the speed of the 2 (bench_engine.cpp). The interface
+// is the same.
+
+struct Cave {
+  explicit Cave(uint64_t seed = clock_seed());
+  // All the random numbers of a Cave (the shuffle of index_perm, the Wumpus' and the player's
+  // first Rooms, the bats, and the Wumpus' moves) come from 1 engine, a Xoshiro256 owned by
+  // the Cave. I first built a new default_random_engine seeded by the clock at each call, but
+  // it is slow (a random_device or the clock at each call), and the games started at the same
+  // tick were the same. Now a game is decided by the seed (and the commands), so it can be
+  // replayed.
+  explicit Cave(Xoshiro256& engine);
+  // A Cave using engine, owned by the caller, instead of its own. The caller decides the seed
+  // and the order of the draws, e.g. to share 1 engine among the Caves of 1 thread, or to save
+  // the engine to replay from the middle of a game. engine must live longer than the Cave.
+
+  static uint64_t clock_seed(){
+    return std::chrono::system_clock::now().time_since_epoch().count();
+  }
+  void seed(uint64_t s){rng().seed(s);}
+  // a uniformly random int in [min, max], drawn from the engine of this Cave
+  int random_int(int min, int max){return rng().uniform_int(min, max);}
+
+  void print();
+  // print the state of the Cave, mainly for debug
+
+  int put_player_initial();
+  // put the player to the Cave for its initial position. Avoid rooms with Wumpus, Pits, and
+  // Bats. The pits and bats can be avoided by using index_perm in this class
+
+  void adjacent_rooms(int rn, int (&adj_rms)[3]) const {
+    // This is how we use a reference to an array. But using vector is better.
+    if(rn<1 || rn>20)
+      error("Error in Cave::adjacent_rooms(int). The argument int must be in [1,20]");
+    adj_rms[0] = rooms[rn].t1, adj_rms[1] = rooms[rn].t2, adj_rms[2] = rooms[rn].t3;
+    // I first used tuple, but since tuple cannot be accessed by using index variable i
+    // (e.g. int i=0; get<i>(adj_rms) generates an error), I switched to using a reference
+  }
+  // print signs of dangers in adjacent rooms
+  void notify_dangers(int rn);
+
+  // the same signs as bits (bat | pit | wumpus), for a program playing the game
+  enum Danger {bat = 1, pit = 2, wumpus = 4};
+  int dangers(int rn) const;
+
+  // true if a tunnel connects Room a and Room b (false if b is not a Room)
+  bool is_adjacent(int a, int b) const;
+
+  // what happened to the player in move_player(), for the caller to tell the player
+  struct Move_report {
+    int carried_to{0};		// the Room a giant bat carried the player to (0 if no bat)
+    bool pit{false};		// the player fell into a pit
+    bool wumpus{false};		// the Wumpus was in the room
+  };
+
+  // Moves the player according to the destination
+  int move_player(int move_dest, Move_report& report);
+
+  int wumpus_startled(bool is_player=true);
+  // It is called when a player enters the room with the Wumpus. The Wumpus is startled by the
+  // entrance, and with 50% of chance, it either stays in the same room or moves to an adjacent
+  // room.
+  // Later I made this member public, because I want to call this from HW_game class (in
+  // HW_game::play(), where an arrow shooting is processed)
+
+  bool shoot_a_room(int shot_rn);
+
+  int clear();
+  // Reset the condition of the cave, i.e. shuffle index_perm again, and assign pits, bats,
+  // and the Wumpus again.
+private:
+  struct Room {
+    int t1,t2,t3;
+    // indices to the rooms to which this Room is connected via the 3 tunnels
+#if defined(CAVE_ROOM_STRUCTS)
+    bool bat, player, wumpus, pit;
+    // indicators of these are in this Room
+    // (Only player is ever set, and nothing reads them. The bitboards below have none.)
+#endif
+    Room()
+      : t1{}, t2{}, t3{}
+    {}
+  };
+  Room rooms[21];
+  // the # of Rooms in a cave is pre-set to 20, from the original Hunt the Wumpus
+  // To make the indices 1-indexed, I prepare 21 Rooms
+  // I make Room definition and rooms private, to avoid accidental change in cave states,
+  // especially the room connections, because they are supposed to be fixed
+
+  int index_perm[20];		// a random permutation of 20 (from 1 to 20, not from 0) indices
+  // used for setting room #s to bat, pit, wumpus, and the player, avoiding picking up the same
+  // room # as those rooms with bat, pit (the Wumpus can be in the same room as bat or pit)
+  // for the initial setting
+
+  int bat_rn[2];		// 2 giant bats' room #s, fixed
+  int pit_rn[2];		// 2 bottomless pits' room #s, fixed
+  int wumpus_rn;		// the Wumpus' room #, can change
+  // Change it only by set_wumpus(), which also changes wumpus_set
+  int player_rn;		// the player's room #, can change
+  // Cave class doesn't have to store the position of the player. There is no member function
+  // to use that information for its process. In put_player_initial() and move_player(int),
+  // they store player_rn, but in those members, player_rn is used only for lvalue, not
+  // rvalue, which means those members doesn't use the information of player_rn for its
+  // processes. So we can cut this variable, and modify those 2 functions not to store
+  // player_rn. But for now, this is just a small piece, so I leave it.
+
+  Xoshiro256 own_gen;		// the only source of random numbers of this Cave,
+  Xoshiro256* outer_gen{nullptr};	// unless an engine is given to the constructor
+  // (a pointer to own_gen instead would point to the old Cave's engine after a copy)
+  Xoshiro256& rng(){return outer_gen ? *outer_gen : own_gen;}
+
+  void connect_rooms();
+
+#if !defined(CAVE_ROOM_STRUCTS)
+  // the bitboards (bit rn is Room rn), the same as bat_rn, pit_rn, and wumpus_rn
+  uint32_t adj_mask[21];	// the Rooms adjacent to each Room
+  uint32_t bat_set;
+  uint32_t pit_set;
+  uint32_t wumpus_set;		// 0 after the Wumpus is hunted
+  static uint32_t room_bit(int rn){return rn > 0 ? uint32_t{1} << rn : 0;}
+  bool has_bat(int rn) const {return bat_set >> rn & 1;}
+  bool has_pit(int rn) const {return pit_set >> rn & 1;}
+  bool has_wumpus(int rn) const {return wumpus_set >> rn & 1;}
+  void set_wumpus(int rn){wumpus_rn = rn, wumpus_set = room_bit(rn);}
+#else
+  bool has_bat(int rn) const {return rn == bat_rn[0] || rn == bat_rn[1];}
+  bool has_pit(int rn) const {return rn == pit_rn[0] || rn == pit_rn[1];}
+  bool has_wumpus(int rn) const {return rn == wumpus_rn;}
+  void set_wumpus(int rn){wumpus_rn = rn;}
+#endif
+
+  int bat_replacement();
+  // It is called when a player enters the room with a bat. It returns a random room number
+  // except the room numbers where bats exist.
+};
+
+inline Cave::Cave(uint64_t seed)
+  : own_gen{seed}
+{
+  connect_rooms();
+  // The random setting of the bats, the pits, the Wumpus (and the player) is the same as in
+  // clear(), so the constructor just calls it
+  clear();
+}
+
+inline Cave::Cave(Xoshiro256& engine)
+  : outer_gen{&engine}
+{
+  connect_rooms();
+  clear();
+}
+
+inline void Cave::connect_rooms(){
+  // Which Room is connected to which is already decided. The structure is from the original
+  // Hunt the Wumpus. Since there seems no regular pattern in the connection, I set them
+  // manually.
+  // Note that the indexing is 1-indexed.
+  rooms[1].t1 = 2, rooms[1].t2 = 5, rooms[1].t3 = 8;
+  rooms[2].t1 = 1, rooms[2].t2 = 3, rooms[2].t3 = 10;
+  rooms[3].t1 = 2, rooms[3].t2 = 4, rooms[3].t3 = 12;
+  rooms[4].t1 =3, rooms[4].t2 = 5, rooms[4].t3 =14;
+  rooms[5].t1 = 1, rooms[5].t2 = 4, rooms[5].t3 = 6;
+  rooms[6].t1 = 5, rooms[6].t2 = 7, rooms[6].t3 = 15;
+  rooms[7].t1 = 6, rooms[7].t2 = 8, rooms[7].t3 = 17;
+  rooms[8].t1 = 1, rooms[8].t2 = 7, rooms[8].t3 = 9;
+  rooms[9].t1 = 8, rooms[9].t2 = 10, rooms[9].t3 = 18;
+  rooms[10].t1 = 2, rooms[10].t2 = 9, rooms[10].t3 = 11;
+  rooms[11].t1 = 10, rooms[11].t2 = 12, rooms[11].t3 = 19;
+  rooms[12].t1 = 3, rooms[12].t2 = 11, rooms[12].t3 = 13;
+  rooms[13].t1 = 12, rooms[13].t2 = 14, rooms[13].t3 = 20;
+  rooms[14].t1 = 4, rooms[14].t2 = 13, rooms[14].t3 = 15;
+  rooms[15].t1 = 6, rooms[15].t2 = 14, rooms[15].t3 = 16;
+  rooms[16].t1 = 15, rooms[16].t2 = 17, rooms[16].t3 = 20;
+  rooms[17].t1 = 7, rooms[17].t2 = 16, rooms[17].t3 = 18;
+  rooms[18].t1 = 9, rooms[18].t2 = 17, rooms[18].t3 = 19;
+  rooms[19].t1 = 11, rooms[19].t2 = 18, rooms[19].t3 = 20;
+  rooms[20].t1 = 13, rooms[20].t2 = 16, rooms[20].t3 = 19;
+
+#if !defined(CAVE_ROOM_STRUCTS)
+  adj_mask[0] = 0;
+  for(int rn=1; rn<21; ++rn)
+    adj_mask[rn] = room_bit(rooms[rn].t1) | room_bit(rooms[rn].t2) | room_bit(rooms[rn].t3);
+#endif
+}
+
+// reset the cave condition
+inline int Cave::clear(){
+  // For randomly picking up random indices without repetition, set a random permutation of
+  // room indices (from 1 to 20)
+  for(int i=1; i<21; ++i)
+    index_perm[i-1] = i;
+  // Be careful on the indexing of index_perm. index_perm[20] has only 20 elements, but the
+  // i starts with 1. So be sure to adjust the indexing by subtracting 1. Otherwise, it accesses
+  // index_perm[20], which is unknown value, and leaves index_perm[0] uninitialized. And if
+  // we proceed with that unknown index_perm[0] value (e.g. 69857296), it can cause illegal
+  // access error (segmentation fault) in the later processes
+  // (It is set again at every clear(), rather than shuffling the last permutation, so that a
+  // game depends only on the state of the engine, e.g. after seed().)
+
+  // shuffle the array uniformly randomly (Fisher-Yates: the element i is swapped with a
+  // random one of [0, i])
+  // I first used std::shuffle(index_perm, index_perm+20, engine), but it makes each index by
+  // a uniform_int_distribution, which divides, and this loop is about 15% faster (the shuffle
+  // is most of clear()). It gives the same distribution. (random_shuffle() is deprecated, so
+  // we shouldn't use it either.)
+  for(int i=19; i>0; --i)
+    swap(index_perm[i], index_perm[random_int(0, i)]);
+
+  // Then, randomly set 2 giant bats, 2 bottomless pits, and 1 Wumpus
+  // for 2 bats
+  bat_rn[0] = index_perm[0];	// index_perm[0] is for the 1st super bat
+  bat_rn[1] = index_perm[1];
+  // Since index_perm is a permutation, we need not worry about the overlap of the room #s
+
+  // for 2 pits
+  pit_rn[0] = index_perm[2];
+  pit_rn[1] = index_perm[3];
+#if !defined(CAVE_ROOM_STRUCTS)
+  bat_set = room_bit(bat_rn[0]) | room_bit(bat_rn[1]);
+  pit_set = room_bit(pit_rn[0]) | room_bit(pit_rn[1]);
+#endif
+
+  // Wumpus, on the other hand, doesn't care about bats or pits, so it can overlap
+  set_wumpus(random_int(1,20));
+  // Don't attach "int" in front, of course. If doing so, a new local variable with the same
+  // name as the one in this class's private section is made, and that local change doesn't
+  // stick to the class member.
+
+  player_rn = put_player_initial();
+  return player_rn;
+}
+
+inline void Cave::notify_dangers(int rn){
+  if(rn<1 || rn>20)
+    error("Error in Cave::notify_dangers(int). The argument int must be in [1,20]");
+
+  int adj_rms[3];
+  adjacent_rooms(rn, adj_rms);
+  int adj_rn;
+  for(int i=0; i<3; ++i){
+    adj_rn = adj_rms[i];
+
+    if(has_bat(adj_rn))
+      cout << "\t I hear a bat\n";
+
+    if(has_pit(adj_rn))
+      cout << "\t I feel a breeze\n";
+
+    if(has_wumpus(adj_rn))
+      cout << "\t I smell the wumpus\n";
+  }
+}
+
+#if !defined(CAVE_ROOM_STRUCTS)
+inline int Cave::dangers(int rn) const {
+  if(rn<1 || rn>20)
+    error("Error in Cave::dangers(int). The argument int must be in [1,20]");
+  uint32_t adj{adj_mask[rn]};
+  return (adj & bat_set ? bat : 0) | (adj & pit_set ? pit : 0) | (adj & wumpus_set ? wumpus : 0);
+}
+
+inline bool Cave::is_adjacent(int a, int b) const {
+  // (unsigned)(rn - 1) < 20 is the same as 1 <= rn <= 20, by 1 comparison
+  return static_cast<unsigned>(a - 1) < 20 && static_cast<unsigned>(b - 1) < 20
+    && (adj_mask[a] >> b & 1);
+}
+#else
+inline int Cave::dangers(int rn) const {
+  int adj_rms[3];
+  adjacent_rooms(rn, adj_rms);
+  int d{0};
+  for(int adj_rn : adj_rms){
+    if(adj_rn == bat_rn[0] || adj_rn == bat_rn[1])
+      d |= bat;
+    if(adj_rn == pit_rn[0] || adj_rn == pit_rn[1])
+      d |= pit;
+    if(adj_rn == wumpus_rn)
+      d |= wumpus;
+  }
+  return d;
+}
+
+inline bool Cave::is_adjacent(int a, int b) const {
+  if(a<1 || a>20)
+    return false;
+  return b == rooms[a].t1 || b == rooms[a].t2 || b == rooms[a].t3;
+}
+#endif
+
+// print the state of the Cave
+inline void Cave::print(){
+  // I gave up printing the structure of the cave, since it's too much work, and little
+  // return
+  // Instead, I will just print where the bats, pits, and Wumpus are
+  // The player's position is always printed at each turn.
+  cout << "The bottomless pits are at Room " << pit_rn[0] << " and " << pit_rn[1] << endl;
+  cout << "The giant bats are at Room " << bat_rn[0] << " and " << bat_rn[1] << endl;
+  cout << "The Wumpus is at Room " << wumpus_rn << endl;
+}
+
+inline int Cave::put_player_initial(){
+  player_rn = index_perm[4];
+  // check if this is not overlapped with the Wumpus (it is guaranteed that this is not
+  // overlapped with pits or bats by using index_perm[4])
+  if(player_rn == wumpus_rn)
+    player_rn = index_perm[5];
+
+#if defined(CAVE_ROOM_STRUCTS)
+  rooms[player_rn].player = true;
+#endif
+  return player_rn;
+}
+
+inline int Cave::move_player(int move_dest, Move_report& report){
+  if(move_dest < 1 || move_dest > 20)
+    error("Error in Cave::move_player(), invalid destination is used");
+
+  // First, check if there is a pit in the destination, because if a pit exists, that results
+  // in the player's death instantly
+  // (Even if the Wumpus is in the room, it may move to an adjacent room witn 50 % chance, so
+  //  So the Wumpus existing in the destination room doesn't necessarily mean the player's
+  //  death)
+  if(has_pit(move_dest)){
+    report.pit = true;		// "The player fell into a pit!"
+    player_rn = -1;		// room -1 means the player is dead
+    return -1;
+  }
+
+  // Second, check the Wumpus, bacause even if a bat and the Wumpus co-exist in the destination
+  // room, if the Wumpus happens to stay in the room, the player is killed, which supercedes
+  // a bat's replacement of the player
+  if(has_wumpus(move_dest)){
+    wumpus_startled();
+    // if, even after the Wumpus is startled by the player, it stays in the same room, the
+    // player is killed by it
+    if(wumpus_rn == move_dest){
+      report.wumpus = true;	// "The Wumpus is in the room!"
+      player_rn = -1;
+      return -1;
+    }
+    else{
+      // Do nothing.
+      // Since we still need to check if a bat exists in the same room, we cannot return
+      // the function here
+    }
+  }
+
+  // Lastly, check if a bat is in the destination. If so, it would carry the player to a random
+  // room except the current room or the room with another bat (bats keep staying in the same
+  // rooms)
+  if(has_bat(move_dest)){
+    int new_dest{bat_replacement()};
+    report.carried_to = new_dest; // "A giant bat has carried you to Room new_dest!"
+    player_rn = move_player(new_dest, report);
+    // If in the new destination, a pit and/or the Wumpus exist, we have to repeat the same
+    // checking process for the new destination. So move_player() is recursively called here.
+    return player_rn;
+  }
+
+  // if no threat exists in the destination room, set player_rn to the destination finally
+  player_rn = move_dest;
+  return player_rn;
+}
+
+inline int Cave::wumpus_startled(bool is_player){
+  // There are 2 types of the Wumpus being startled, 1st is by the player entering the Room
+  // the Wumpus is in, and 2nd is by the player shooting an arrow moving across Rooms.
+  // In the former case, the probability of the Wumpus moving to an adjacent Room is 50 %,
+  // but in the latter case, it moves to an adjacent Room for sure (100 %).
+  // The default value of "is_player" is true.
+
+  if(wumpus_rn < 0){
+    return wumpus_rn;		// if the Wumpus has been already hunted, just return the
+    // same Room #, which is -1.
+  }
+
+  if(is_player){
+    // 1st create a uniformly random number in [0,1.0)
+    double rn{rng().uniform_real()};
+
+    if(rn < 0.5){
+      int adj_rms[3];
+      adjacent_rooms(wumpus_rn, adj_rms);
+      double rn2{rng().uniform_real()}; // generate a 2nd uniformly random number in [0, 1.0)
+      if(rn2<(1.0/3)) set_wumpus(adj_rms[0]);
+      else if(rn2<(2.0/3)) set_wumpus(adj_rms[1]);
+      else set_wumpus(adj_rms[2]);
+    }
+    else{				// stay in the same room
+      // do nothing
+    }
+  }
+  else{				// the case where the arrow startled the Wumpus
+    int adj_rms[3];
+    adjacent_rooms(wumpus_rn, adj_rms);
+    set_wumpus(adj_rms[random_int(0,2)]);
+  }
+
+  return wumpus_rn;
+}
+
+inline int Cave::bat_replacement(){
+  return index_perm[random_int(2,19)];
+  // index_perm[0,1] are the Room #s for the 2 giant bats. A bat moves the player randomly
+  // to a Room without a bat, so choose the index from 2 to 19, inclusive.
+  // (random_int(min, max) generates a random number in [min, max], including min and max)
+  // (It was rand_int(2,20) before, which sometimes read index_perm[20], 1 past the end.)
+
+  // We can include index_perm[0,1] for the bats to choose a room with a bat as well.
+  // If I change the code that way, Cave::move_player() works correctly, because in the
+  // if-sentence for bat checking, it calls itself recursively.
+}
+
+inline bool Cave::shoot_a_room(int shot_rn){
+  if(shot_rn < 1 || shot_rn > 20)
+    error("Error in Cave::shoot_a_room(int). The room # must be in [1,20]");
+
+  if(has_wumpus(shot_rn)){
+    set_wumpus(-1);		// Room -1 means the Wumpus has been hunted.
+    return true;
+  }
+  return false;
+}
+
+#endif // CAVE_GUARD
@@ -0,0 +1,88 @@
+
+#ifndef MONTE_CARLO_GUARD
+#define MONTE_CARLO_GUARD 1
+
+#include "./std_lib_facilities.h"
+#include "wumpus_engine.h"
+#include<cstdint>
+#include<atomic>
+#include<thread>
+#include<exception>		// for exception_ptr
+
+// Evaluating a policy over very many games on all the cores:
+//   Game_stats st{run_games(1000000000, Smell_policy{}, 42)};
+//   cout << st.win_rate();
+// Each thread owns its Wumpus_engine (with its Cave and random engine) and a copy of the
+// policy, takes the next shard of games from a shared counter, and adds the results to its own
+// Game_stats; they are added together at the end (Game_stats::operator+=).
+// The result depends only on the seed, not on the number of threads: game g is played after
+// seeding the engine by game_seed(seed, g), whichever thread plays it, and the policy draws its
+// random numbers from the engine too (Wumpus_engine::random_int()). So a policy must keep no
+// state from 1 game to the next, or the result would depend on which games a thread played
+// before. The counts of Game_stats are only added, so the order of the shards doesn't matter.
+
+// the seed of game g: the bits of seed and g mixed by the finalizer of splitmix64, so that the
+// seeds of neighbouring games (or of seed and seed+1) look unrelated
+inline uint64_t game_seed(uint64_t seed, uint64_t g){
+  uint64_t z{seed*0x9e3779b97f4a7c15ULL + g + 1};
+  z = (z ^ (z >> 30))*0xbf58476d1ce4e5b9ULL;
+  z = (z ^ (z >> 27))*0x94d049bb133111ebULL;
+  return z ^ (z >> 31);
+}
+
+// Play games [first, first+n) with their own seeds, and add their results to st
+template<typename Policy>
+void run_shard(Wumpus_engine& e, Policy& policy, uint64_t seed, uint64_t first, uint64_t n,
+	       int max_turns, Game_stats& st){
+  for(uint64_t g=first; g<first+n; ++g){
+    e.seed(game_seed(seed, g));
+    play_game(e, policy, max_turns, st);
+  }
+}
+
+// Play n games with policy on num_threads threads (including the calling one), in shards of
+// shard_games games, and return the sum of their results. max_turns is as in play_games()
+template<typename Policy>
+Game_stats run_games(uint64_t n, const Policy& policy, uint64_t seed,
+		     int num_threads = static_cast<int>(thread::hardware_concurrency()),
+		     uint64_t shard_games = 4096, int max_turns = 1000){
+  num_threads = max(num_threads, 1);
+  shard_games = max<uint64_t>(shard_games, 1);
+  uint64_t shards{(n + shard_games - 1)/shard_games};
+  num_threads = static_cast<int>(max<uint64_t>(1, min<uint64_t>(num_threads, shards)));
+  vector<Game_stats> results(num_threads);
+  vector<exception_ptr> errors(num_threads);
+  atomic<uint64_t> next{0};
+  auto work = [&](int t){
+    try{
+      Wumpus_engine e{0};
+      Policy p{policy};
+      Game_stats mine;		// not results[t] directly, which shares a cache line with
+				// the results of the other threads
+      for(uint64_t s{next++}; s < shards; s = next++){
+	uint64_t first{s*shard_games};
+	run_shard(e, p, seed, first, min(shard_games, n - first), max_turns, mine);
+      }
+      results[t] = mine;
+    }
+    catch(...){
+      errors[t] = current_exception();
+      next = shards;		// the others stop after their current shard
+    }
+  };
+  vector<thread> threads;
+  for(int t=1; t<num_threads; ++t)
+    threads.emplace_back(work, t);
+  work(0);
+  for(thread& th : threads)
+    th.join();
+  for(exception_ptr& e : errors)
+    if(e)
+      rethrow_exception(e);
+  Game_stats total;
+  for(Game_stats& st : results)
+    total += st;
+  return total;
+}
+
+#endif // MONTE_CARLO_GUARD
@@ -0,0 +1,63 @@
+
+#ifndef RANDOM_ENGINE_GUARD
+#define RANDOM_ENGINE_GUARD 1
+
+#include "./std_lib_facilities.h"
+#include<cstdint>
+#include<limits>
+
+// xoshiro256** (Blackman and Vigna, https://prng.di.unimi.it/): a random engine of 4 uint64_t
+// of state, which makes a 64-bit number by a few shifts, rotations, and xors (about 1ns). It
+// passes the statistical tests which default_random_engine (minstd_rand0 of libstdc++, whose
+// numbers are only 31 bits) fails, and its period is 2^256 - 1, so the games of different
+// seeds don't overlap.
+// It meets the requirements of a uniform random bit generator, so it works with shuffle() and
+// the distributions of <random> as well.
+class Xoshiro256 {
+public:
+  using result_type = uint64_t;
+  explicit Xoshiro256(uint64_t seed = 0){this->seed(seed);}
+
+  // the state from seed by splitmix64, as the authors recommend (any seed, even 0, gives a
+  // state which is not all 0)
+  void seed(uint64_t seed){
+    for(uint64_t& x : s){
+      uint64_t z{seed += 0x9e3779b97f4a7c15ULL};
+      z = (z ^ (z >> 30))*0xbf58476d1ce4e5b9ULL;
+      z = (z ^ (z >> 27))*0x94d049bb133111ebULL;
+      x = z ^ (z >> 31);
+    }
+  }
+
+  static constexpr result_type min(){return 0;}
+  static constexpr result_type max(){return numeric_limits<result_type>::max();}
+
+  result_type operator()(){
+    uint64_t result{rotl(s[1]*5, 7)*9};
+    uint64_t t{s[1] << 17};
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = rotl(s[3], 45);
+    return result;
+  }
+
+  // a uniformly random int in [min, max]: the high 32 bits times the size of the range, whose
+  // high 32 bits are the number (Lemire's multiply-shift, without a division). Its bias is
+  // under size/2^32, less than 1e-8 for the ranges of a Cave
+  int uniform_int(int min, int max){
+    uint64_t size{static_cast<uint64_t>(static_cast<int64_t>(max) - min + 1)};
+    return min + static_cast<int>(((*this)() >> 32)*size >> 32);
+  }
+  // a uniformly random double in [0, 1.0), from the high 53 bits
+  double uniform_real(){return ((*this)() >> 11)*(1.0/(1ULL << 53));}
+
+private:
+  uint64_t s[4];
+
+  static uint64_t rotl(uint64_t x, int k){return (x << k) | (x >> (64 - k));}
+};
+
+#endif // RANDOM_ENGINE_GUARD
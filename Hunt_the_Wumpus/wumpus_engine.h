@@ -0,0 +1,302 @@
+
+#ifndef WUMPUS_ENGINE_GUARD
+#define WUMPUS_ENGINE_GUARD 1
+
+#include "./std_lib_facilities.h"
+#include "cave.h"
+#include<cstdint>
+
+// The rules of 1 game of Hunt the Wumpus without any input or output, so that a program can
+// play millions of games (e.g. to see how often a strategy wins). HW_game (main.cpp) reads
+// the commands of a person and prints what happened, and this engine does everything between:
+//   Wumpus_engine e{seed};
+//   Outcome o{e.step(Command{'m', {5, -1, -1}})};	// move to Room 5
+//   if(o.state == Game_state::lost) ... o.cause ...
+// step() only changes ints and returns them in an Outcome, so the strings of the messages are
+// made only by a caller who prints them. play_games() plays n games with a policy, a function
+// that chooses the command of each turn.
+
+// Command class is used for reading commands by a player of Hunt the Wumpus game, such as
+// "s13-4-3".
+// I first place Command class inside HW_game class's private section, but if I do so, in the
+// operator overload of >>, I cannot specify Command class as its 2nd argument. Probably I can
+// still place Command class inside HW_game class's public section, and call it in the 2nd
+// argument of >>, but I'd rather choose to place it outside of HW_game class.
+struct Command{		// e.g. s13-4-3
+    char move;			// either 's' (shoot) or 'm' (move)
+    int room_nums[3];		// At most 3 room numbers are specified
+    // In 'm', room_nums[0] is the next room to move to
+    // In 's', room_nums[0,1,2] specifies the rooms the arrow moves along
+    // If illegal room numbers are specified in 's', they are replaced with random valid
+    // (adjacent) room numbers.
+};
+
+enum class Game_state {playing, won, lost};
+
+// how a game was lost
+enum class Cause {
+  none,
+  pit,			// moved into a bottomless pit
+  wumpus,		// moved into the Room of the Wumpus, and it stayed
+  startled_wumpus,	// an arrow startled the Wumpus, and it entered the player's Room
+  own_arrow,		// the arrow came back to the player's Room
+  no_arrows,		// shot the last arrow without hunting the Wumpus
+  count			// the number of the causes above
+};
+
+// what happened in 1 turn
+struct Outcome {
+  bool valid{true};		// false if the command was not done (a move to a Room not
+				// adjacent, or a command after the end of the game)
+  Game_state state{Game_state::playing};
+  Cause cause{Cause::none};
+  int player_rn{-1};		// the player's Room after the turn, -1 if dead
+  int carried_to{0};		// the Room a giant bat carried the player to, 0 if no bat
+  int shot_rms[3]{-1, -1, -1};	// the Rooms the arrow went through, -1 after its end
+};
+
+class Wumpus_engine {
+public:
+  explicit Wumpus_engine(uint64_t seed = Cave::clock_seed())
+    : cave_{seed}
+  {
+    new_game();
+  }
+  // an engine whose cave draws from engine, owned by the caller (see Cave::Cave(Xoshiro256&))
+  explicit Wumpus_engine(Xoshiro256& engine)
+    : cave_{engine}
+  {
+    new_game();
+  }
+
+  // start a new game in the same cave (the bats, the pits, the Wumpus, and the player are put
+  // at random again), and return the player's Room
+  int new_game();
+  // reseed the random engine of the cave. After seed(s) and new_game(), the same commands
+  // give the same game
+  void seed(uint64_t s){cave_.seed(s);}
+
+  // do 1 command of the player. A move must be to an adjacent Room, or it is not valid and
+  // nothing happens; a shoot is always valid (the Rooms not adjacent are replaced by random
+  // ones)
+  Outcome step(const Command& cmd);
+  bool is_valid_move(const Command& cmd) const;
+
+  Game_state state() const {return game_state;}
+  int player_room() const {return player_rn;}
+  int arrows() const {return num_arrows;}
+  int turns() const {return turn_count;}	// the valid commands of this game
+  void adjacent_rooms(int rn, int (&adj_rms)[3]) const {cave_.adjacent_rooms(rn, adj_rms);}
+  // the signs the player notices in the current Room (Cave::Danger bits)
+  int dangers() const {return cave_.dangers(player_rn);}
+  // a random int in [min, max] from the engine of the cave, for a policy to draw from, so
+  // that a game is decided by the seed alone
+  int random_int(int min, int max){return cave_.random_int(min, max);}
+
+  Cave& cave(){return cave_;}
+
+private:
+  Cave cave_;
+  int player_rn;
+  int num_arrows;
+  // The number of arrow the player can shoot is not mentioned either on the book or on
+  // Wikipedia. But to make the game a little realistic and fun, I set a maximum number
+  // of arrows. If the player runs out of all arrows, he loses.
+  int turn_count;
+  Game_state game_state;
+
+  bool shoot_rooms(const Command& cmd, Outcome& o);
+};
+
+inline int Wumpus_engine::new_game(){
+  player_rn = cave_.clear();
+  num_arrows = 5;
+  turn_count = 0;
+  game_state = Game_state::playing;
+  return player_rn;
+}
+
+inline bool Wumpus_engine::is_valid_move(const Command& cmd) const {
+  // If the move is shoot, always return true regardless of the destination of the shoot
+  if(cmd.move == 's')
+    return true;
+  if(cmd.move != 'm')
+    return false;
+
+  return cave_.is_adjacent(player_rn, cmd.room_nums[0]);
+}
+
+// shoot the Rooms of cmd, and return true if the Wumpus is hunted
+inline bool Wumpus_engine::shoot_rooms(const Command& cmd, Outcome& o){
+  int current_rn{player_rn};
+  bool HUNTED_WUMPUS{false};
+
+  for(int i=0; i<3; ++i){
+    // It's possible that the player enters only 1 or 2 room(s), e.g. s13. In that case,
+    // cmd.room_nums[1,2] == -1. So break the loop once -1 is detected.
+    if(cmd.room_nums[i] == -1)
+      break;
+
+    // check if the destination of the arrow is included in the adjacent rooms. If not, set
+    // a random yet valid (adjacent) room #
+    if(cave_.is_adjacent(current_rn, cmd.room_nums[i]))
+      current_rn = cmd.room_nums[i];
+    else{
+      int adj_rms[3];
+      cave_.adjacent_rooms(current_rn, adj_rms);
+      current_rn = adj_rms[cave_.random_int(0,2)];
+    }
+
+    // Before checking if the Wumpus is hunted by the arrow, check if the arrow comes to
+    // the player's own room. In that case, the player is killed by his own arrow, according
+    // to Wikipedia
+    if(current_rn == player_rn){
+      o.cause = Cause::own_arrow;
+      player_rn = -1;
+      return false;
+    }
+    HUNTED_WUMPUS = cave_.shoot_a_room(current_rn);
+    o.shot_rms[i] = current_rn;
+    if(HUNTED_WUMPUS)
+      break;
+  }
+  return HUNTED_WUMPUS;
+}
+
+inline Outcome Wumpus_engine::step(const Command& cmd){
+  Outcome o;
+  if(game_state != Game_state::playing || !is_valid_move(cmd)){
+    o.valid = false;
+    o.state = game_state;
+    o.player_rn = player_rn;
+    return o;
+  }
+  ++turn_count;
+
+  bool WUMPUS_HUNTED{false};
+  if(cmd.move == 'm'){
+    Cave::Move_report r;
+    player_rn = cave_.move_player(cmd.room_nums[0], r);
+    o.carried_to = r.carried_to;
+    if(r.pit)
+      o.cause = Cause::pit;
+    else if(r.wumpus)
+      o.cause = Cause::wumpus;
+  }
+  else{			// cmd is shoot 's'
+    WUMPUS_HUNTED = shoot_rooms(cmd, o);
+    // According to Wikipedia's gameplay explanation, every time after an arrow is shot,
+    // the Wumpus is startled, and moves to an adjacent room
+    num_arrows--;
+
+    // As a result of the Wumpus moving after the shoot, if the Wumpus comes to the player's
+    // Room, the player is killed
+    if(cave_.wumpus_startled(false) == player_rn){
+      o.cause = Cause::startled_wumpus;
+      player_rn = -1;
+    }
+  }
+
+  if(player_rn < 0)		// the player is dead, either by a pit or the Wunpus
+    game_state = Game_state::lost;
+  else if(WUMPUS_HUNTED)
+    game_state = Game_state::won;
+  // The checking of the number of arrows should come after the checking of whether the Wumpus
+  // was hunted or not, because even when the number of arrows becomes 0, it's possible that
+  // the last arrow hunted the Wumpus.
+  else if(num_arrows < 1){
+    o.cause = Cause::no_arrows;
+    game_state = Game_state::lost;
+  }
+
+  o.state = game_state;
+  o.player_rn = player_rn;
+  return o;
+}
+
+// =========================================================================================
+
+// the results of many games
+struct Game_stats {
+  uint64_t games{0};
+  uint64_t wins{0};
+  uint64_t turns{0};		// of all the games
+  uint64_t unfinished{0};	// stopped at max_turns of play_games()
+  uint64_t losses[static_cast<int>(Cause::count)]{};	// by the cause
+
+  uint64_t lost(Cause c) const {return losses[static_cast<int>(c)];}
+  double win_rate() const {return games ? double(wins)/games : 0;}
+  double turns_per_game() const {return games ? double(turns)/games : 0;}
+
+  // add the results of other games (e.g. of another thread). Only counts are added, so the
+  // sum is the same in any order
+  Game_stats& operator+=(const Game_stats& o){
+    games += o.games;
+    wins += o.wins;
+    turns += o.turns;
+    unfinished += o.unfinished;
+    for(int c=0; c<static_cast<int>(Cause::count); ++c)
+      losses[c] += o.losses[c];
+    return *this;
+  }
+};
+
+// Play 1 game from new_game() with policy, and add its result to st
+template<typename Policy>
+void play_game(Wumpus_engine& e, Policy& policy, int max_turns, Game_stats& st){
+  e.new_game();
+  Outcome o;
+  for(int t=0; t<max_turns && e.state() == Game_state::playing; ++t)
+    o = e.step(policy(e));
+  ++st.games;
+  st.turns += e.turns();
+  if(e.state() == Game_state::won)
+    ++st.wins;
+  else if(e.state() == Game_state::lost)
+    ++st.losses[static_cast<int>(o.cause)];
+  else
+    ++st.unfinished;
+}
+
+// Play n games with policy, a function (or an object with operator()) which takes the
+// Wumpus_engine& and returns the Command of the turn. It may look at state of the player (
+// player_room(), arrows(), dangers(), adjacent_rooms()) and draw random numbers from
+// random_int(). A game which is not over after max_turns commands (e.g. a policy which never
+// shoots) is stopped and counted as unfinished. The games follow each other from the state of
+// the random engine of e; run_games() of monte_carlo.h seeds each game by itself instead.
+template<typename Policy>
+Game_stats play_games(Wumpus_engine& e, uint64_t n, Policy&& policy, int max_turns = 1000){
+  Game_stats st;
+  for(uint64_t g=0; g<n; ++g)
+    play_game(e, policy, max_turns, st);
+  return st;
+}
+
+// 2 simple policies, as examples and for benchmarks
+
+// moves to a random adjacent Room, and 1 of shoot_one_in turns shoots through 3 random Rooms
+struct Random_policy {
+  int shoot_one_in{8};
+  Command operator()(Wumpus_engine& e) const {
+    int adj_rms[3];
+    e.adjacent_rooms(e.player_room(), adj_rms);
+    if(e.random_int(1, shoot_one_in) == 1)
+      return Command{'s', {e.random_int(1,20), e.random_int(1,20), e.random_int(1,20)}};
+    return Command{'m', {adj_rms[e.random_int(0,2)], -1, -1}};
+  }
+};
+
+// shoots 1 random adjacent Room when it smells the Wumpus, and otherwise moves to a random
+// adjacent Room
+struct Smell_policy {
+  Command operator()(Wumpus_engine& e) const {
+    int adj_rms[3];
+    e.adjacent_rooms(e.player_room(), adj_rms);
+    int rn{adj_rms[e.random_int(0,2)]};
+    if(e.dangers() & Cave::wumpus)
+      return Command{'s', {rn, -1, -1}};
+    return Command{'m', {rn, -1, -1}};
+  }
+};
+
+#endif // WUMPUS_ENGINE_GUARD
@@ -263,6 +263,11 @@ public:
   T& operator[](int n){return this->elem[n];}
   T operator[](int n) const {return this->elem[n];}
 
+  // the elements as 1 contiguous array, like std::vector::data(), e.g. to write them to a
+  // file at once (see write_array() in file_handler/record_io.h)
+  T* data(){return this->elem;}
+  const T* data() const {return this->elem;}
+
   // range-checking access at() (p693-694)  
   T& at(int n){
     if(n<0 || this->sz<=n) throw Out_of_range();
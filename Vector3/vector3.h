@@ -262,6 +262,11 @@ class Vector3
     T& operator[](int n){return this->vec_data->elem[n];}
     T operator[](int n) const {return this->vec_data->elem[n];}
 
+    // the elements as 1 contiguous array, like std::vector::data(). nullptr if empty (the
+    // same as begin())
+    T* data(){return begin();}
+    const T* data() const {return begin();}
+
     // range-checking access at() (p693-694)  
     T& at(int n){
       // It's possible that a user make an empty Vector3<T>, and try to call this function.
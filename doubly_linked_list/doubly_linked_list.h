@@ -3,6 +3,25 @@
 #define DOUBLY_LINKED_LIST_GUARD 1
 
 #include "std_lib_facilities.h"
+#include<new>			// for placement new in compact()
+#include<functional>		// for std::less<> in delete_link()
+
+// Checking policy of List<Elem>'s iterators.
+// A checked iterator behaves like the original one: ++end() goes to begin() and --begin() goes
+// to the last element (circulation), dereferencing end() throws runtime_error, and comparing
+// iterators of different Lists throws as well. An unchecked iterator only chases succ/prev
+// pointers: it doesn't look into the List on each step (only --end() needs lst->last), and
+// doesn't test for 0 before dereferencing, so ++end(), --begin(), or *end() is undefined,
+// like STL's iterators.
+// By default, iterator and const_iterator are checked, and in release builds (-DNDEBUG) they
+// become unchecked. LIST_CHECKED_ITERATOR can be defined to 0 or 1 to choose it explicitly.
+#ifndef LIST_CHECKED_ITERATOR
+#ifdef NDEBUG
+#define LIST_CHECKED_ITERATOR 0
+#else
+#define LIST_CHECKED_ITERATOR 1
+#endif
+#endif
 
 template<typename Elem>
 struct Link {
@@ -35,7 +54,7 @@ public:
   // size of a single pointer".
 
   List()
-    : first{0}, last{first}, sz{0}
+    : first{0}, last{first}, sz{0}, pool{nullptr}, pool_sz{0}
       // both point to the Link<Elem> element which is the end() element, so this element is
       // not counted as 1 element.
       // It assumes that Elem type has default (empty) constructor
@@ -49,14 +68,14 @@ public:
   //                    assignment, initializer_list constructor
 
   
-  List(initializer_list<Elem> lst) : first{0}, last{first}, sz{0}
+  List(initializer_list<Elem> lst) : first{0}, last{first}, sz{0}, pool{nullptr}, pool_sz{0}
   {
     for(const auto e : lst)
       push_back(e);
   }
   
   // copy constructor
-  List(const List<Elem>& lst) : first{0}, last{first}, sz{0}
+  List(const List<Elem>& lst) : first{0}, last{first}, sz{0}, pool{nullptr}, pool_sz{0}
   {
     // create the same number of Link<Elem> objects, and copy lst's elements
     for(const auto a : lst)	// a is Elem type, not Link<Elem> type
@@ -101,15 +120,19 @@ public:
   }
   
   // move constructor
-  List(const List<Elem>&& lst) : first{0}, last{first}, sz{0}
+  List(const List<Elem>&& lst) : first{0}, last{first}, sz{0}, pool{nullptr}, pool_sz{0}
   {
     // rob lst of its elements
     first = lst.first;
     last = lst.last;
     sz = lst.sz;
+    pool = lst.pool;
+    pool_sz = lst.pool_sz;
 
     // to prevent lst's elements from being destroyed in lst's destructor, set lst's sz to 0
     lst.sz = 0;
+    lst.pool = nullptr;		// the same for the block made by compact()
+    lst.pool_sz = 0;
   }
   // move assignment operator
   List<Elem>& operator=(const List<Elem>&& a){
@@ -121,19 +144,25 @@ public:
     first = a.first;
     last = a.last;
     sz = a.sz;
+    pool = a.pool;
+    pool_sz = a.pool_sz;
     // to prevent a's elements from being destroyed in a's destructor, set a's sz to 0
     a.sz = 0;
+    a.pool = nullptr;
+    a.pool_sz = 0;
 
     return *this;
   }
   
   ~List(){
-    iterator p{begin()}, p2{iterator(this, p.curr->succ)}; // p2 points to the next Link<> to p
-    for(int i=0; i<sz; ++i){			     // delete except end() element
-      delete p.curr;
+    Link<Elem>* p{first};
+    for(size_type i=0; i<sz; ++i){		     // delete except end() element
+      Link<Elem>* p2{p->succ};	// p2 points to the next Link<> to p
+      delete_link(p);
       p = p2;
-      ++p2;
     }
+    // I use raw pointers here instead of iterators, because with unchecked iterators,
+    // ++end() is not allowed (the last p2 is end()).
     // in the end, delete end(). now p points to end() (p2 holds iterator(nullptr))
     //delete p.curr;
     // <- in ex 13, I replaced end()'s Link<Elem> with just 0
@@ -142,9 +171,15 @@ public:
     first = 0;
     last = 0;
     sz = 0;
+    ::operator delete(pool);	// the links in it were already destroyed by delete_link()
+    pool = nullptr;
+    pool_sz = 0;
   }
   
-  class iterator;
+  template<bool checked> class basic_iterator;
+  using iterator = basic_iterator<(LIST_CHECKED_ITERATOR != 0)>;
+  using checked_iterator = basic_iterator<true>;
+  using unchecked_iterator = basic_iterator<false>;
   iterator begin(){return iterator(this, first);}
   iterator end(){
     // if(sz) return iterator(last->succ);
@@ -162,7 +197,8 @@ public:
     // in ex 13 I represent end() with just 0
   }
 
-  class const_iterator;
+  template<bool checked> class basic_const_iterator;
+  using const_iterator = basic_const_iterator<(LIST_CHECKED_ITERATOR != 0)>;
   const_iterator begin()const {return const_iterator(this, first);}
   const_iterator end()const {
     // if(sz) return const_iterator(last->succ);
@@ -173,6 +209,12 @@ public:
     return const_iterator(this, 0);
   }
 
+  // iterators with an explicitly chosen policy, regardless of LIST_CHECKED_ITERATOR
+  checked_iterator checked_begin(){return checked_iterator(this, first);}
+  checked_iterator checked_end(){return checked_iterator(this, 0);}
+  unchecked_iterator unchecked_begin(){return unchecked_iterator(this, first);}
+  unchecked_iterator unchecked_end(){return unchecked_iterator(this, 0);}
+
   size_type size(){return sz;}
   
   iterator insert(iterator p, const Elem& v); // insert v into list before p
@@ -186,6 +228,24 @@ public:
   
   void pop_front();		  // remove the 1st element
   void pop_back();		  // remove the last element
+
+  // Traversal helpers for long lists. A traversal of a linked list waits for a cache miss
+  // on every link, so these helpers run a 2nd pointer "dist" links ahead of the current one,
+  // and prefetch the links it reaches. The misses of the links ahead then overlap with the
+  // work on the current link. It helps more when f does more work per element.
+  template<typename F>
+  void for_each(F f, int dist=default_prefetch_dist); // call f(elem) on each element in order
+  iterator find(const Elem& v, int dist=default_prefetch_dist); // 1st element ==v, or end()
+  template<typename T>
+  T accumulate(T init, int dist=default_prefetch_dist) const; // init + sum of all elements
+
+  void compact();
+  // Re-allocate all the links in traversal order into 1 contiguous block, so that later
+  // traversals read memory sequentially (and the hardware prefetcher works). All iterators
+  // to this list become invalid.
+  // Links inserted after compact() are allocated by new as usual.
+
+  static constexpr int default_prefetch_dist{8};
   
   Elem& front(){
     if(begin()==end()) throw("Error in list<Elem>::front(). No element exists in this list.");
@@ -208,6 +268,42 @@ private:
   //Link<Elem>* e;
   // to simplify end() function, I prepare the pointer to end() element
   // <- in ex 13, I represent end() with just 0
+
+  Link<Elem>* pool;		// the block of links made by compact(), or nullptr
+  size_type pool_sz;		// the number of links the block can hold
+
+  // The 2nd pointer of the prefetching traversals (for_each(), find(), and accumulate()). It
+  // starts dist links ahead of the first link, and each link it reaches is prefetched, so by
+  // the time the traversal comes to a link, the link is likely in the cache already.
+  struct Prefetch_cursor {
+    Link<Elem>* ahead;
+    Prefetch_cursor(Link<Elem>* first, int dist)
+      : ahead{first}
+    {
+      for(int i=0; i<dist && ahead!=0; ++i){
+	__builtin_prefetch(ahead);
+	ahead = ahead->succ;
+      }
+    }
+    // called once per link of the traversal
+    void advance(){
+      if(ahead != 0){
+	__builtin_prefetch(ahead->succ);
+	// prefetch the link after next, so that the next "ahead = ahead->succ" hits the cache.
+	// __builtin_prefetch() of GCC/Clang never faults, even for 0
+	ahead = ahead->succ;
+      }
+    }
+  };
+  // A link in the block cannot be deleted one by one, so every link is freed by delete_link()
+  // (instead of delete), and the block itself is freed in the destructor or the next compact()
+  void delete_link(Link<Elem>* p){
+    less<const Link<Elem>*> before;	// total order, even for pointers to different objects
+    if(!before(p, pool) && before(p, pool+pool_sz))
+      p->~Link();			// in the block. Only destroy it
+    else
+      delete p;
+  }
 };
 
 template<typename Elem>
@@ -269,8 +365,6 @@ typename List<Elem>::iterator List<Elem>::insert(iterator p, const Elem& v){
 
 template<typename Elem>
 typename List<Elem>::iterator List<Elem>::erase(iterator p){
-  iterator k{++p};			// points to the next element to p
-  --p;					// return p to its original position
   if(begin()==end())
     throw runtime_error("Error in list<Elemt>::erase(). No element exists in this list.");
 
@@ -322,7 +416,10 @@ typename List<Elem>::iterator List<Elem>::erase(iterator p){
     // is classified into p!=end() case above
     throw runtime_error("Error in list<Elemt>::erase(). The given iterator doesn't point to any of the elements");
   }
-  delete p.curr;
+  iterator k(this, p.curr->succ);	// points to the next element to p
+  // k is made after p is checked not to be end(), since ++end() is not allowed for unchecked
+  // iterators
+  delete_link(p.curr);
   --sz;
   return k;
 }
@@ -388,7 +485,7 @@ void List<Elem>::pop_front(){
 
   if(sz == 1){
     // in this case, both first and last are moved to pointing to the end() element
-    delete first;
+    delete_link(first);
     // first = e;
     // last = e;
     // <- in ex 13, I represent end() with just 0, so there is no end() element of Link<>
@@ -399,7 +496,7 @@ void List<Elem>::pop_front(){
     // in this case, only first pointer is moved to the successor
     Link<Elem>* p{first};
     first = first->succ;
-    delete p;
+    delete_link(p);
   }
   --sz;
 }
@@ -411,7 +508,7 @@ void List<Elem>::pop_back(){
 
   if(sz == 1){
     // in this case, both first and last are moved to pointing to the end() element
-    delete first;
+    delete_link(first);
     // first = e;
     // last = e;
     // <- in ex 13, I represent end() with just 0, so there is no end() element of Link<>
@@ -425,14 +522,97 @@ void List<Elem>::pop_back(){
     //last->succ = e;		// connect the new last's successor to end()
     // <- in ex 13, I represent end() with just 0, so there is no end() element of Link<>
     last->succ = 0;
-    delete p;
+    delete_link(p);
   }
   --sz;
 }
 
+// The prefetching traversals, with Prefetch_cursor (see the private section of List)
+template<typename Elem>
+template<typename F>
+void List<Elem>::for_each(F f, int dist){
+  Link<Elem>* p{first};
+  Prefetch_cursor ahead{first, dist};
+  for(size_type i=0; i<sz; ++i){
+    ahead.advance();
+    f(p->val);
+    p = p->succ;
+  }
+}
+
+template<typename Elem>
+typename List<Elem>::iterator List<Elem>::find(const Elem& v, int dist){
+  Link<Elem>* found{0};			// 0 == end()
+  Link<Elem>* p{first};
+  Prefetch_cursor ahead{first, dist};
+  // the same as for_each() above, but stops at the 1st match
+  for(; p!=0; p=p->succ){
+    ahead.advance();
+    if(p->val == v){
+      found = p;
+      break;
+    }
+  }
+  return iterator(this, found);
+}
+
+template<typename Elem>
+template<typename T>
+T List<Elem>::accumulate(T init, int dist) const {
+  Link<Elem>* p{first};
+  Prefetch_cursor ahead{first, dist};
+  for(size_type i=0; i<sz; ++i){
+    ahead.advance();
+    init = init + p->val;
+    p = p->succ;
+  }
+  return init;
+}
+
+template<typename Elem>
+void List<Elem>::compact(){
+  if(sz == 0)
+    return;
+
+  // allocate the memory for sz links at once, and construct the links in traversal order
+  // by placement new (like allocator<T>::construct() does)
+  Link<Elem>* block{static_cast<Link<Elem>*>(::operator new(sz*sizeof(Link<Elem>)))};
+  Link<Elem>* p{first};
+  size_type i{0};
+  try{
+    for(; i<sz; ++i, p=p->succ)
+      new(&block[i]) Link<Elem>(p->val); // copy constructor of Elem is assumed to exist
+  }
+  catch(...){
+    // destroy the links constructed so far, and leave this list as it was
+    for(size_type j=0; j<i; ++j)
+      block[j].~Link();
+    ::operator delete(block);
+    throw;
+  }
+  for(i=0; i<sz; ++i)
+    block[i].succ = (i+1<sz) ? &block[i+1] : 0;
+  for(i=0; i<sz; ++i)
+    block[i].prev = (i>0) ? &block[i-1] : nullptr;
+  // free the old links (some of them may be in the block of the previous compact())
+  p = first;
+  for(i=0; i<sz; ++i){
+    Link<Elem>* p2{p->succ};
+    delete_link(p);
+    p = p2;
+  }
+  ::operator delete(pool);
+
+  pool = block;
+  pool_sz = sz;
+  first = block;
+  last = &block[sz-1];
+}
+
 // define class iterator declared inside list<Elem> (p727)
 template<typename Elem>
-class List<Elem>::iterator {
+template<bool checked>
+class List<Elem>::basic_iterator {
 public:
   // made curr public, because I wanted to refer to it in list<Elem>::insert() from an iterator
   // object
@@ -461,21 +641,25 @@ public:
   // This additional 8 bits required for this additiona pointer lst is 1 cost of achieving
   // such a circulation iterator (the other cost is the relatively complex code compared to
   // the previous version of iterator).
-  iterator(const List<Elem>* llst, Link<Elem>* p) : curr{p}, lst{llst} {}
-
-  iterator& operator++(){	// forward
-    if(lst->end().curr == curr){				   // <= curr==0
-      curr = lst->begin().curr;
+  basic_iterator(const List<Elem>* llst, Link<Elem>* p) : curr{p}, lst{llst} {}
+
+  // "checked" is a compile-time constant, so in unchecked iterators, the if-sentences on it
+  // are removed by the compiler. I also compare curr with 0 directly, instead of building
+  // lst->end() and lst->begin() on each step.
+  basic_iterator& operator++(){	// forward
+    if(checked && curr == 0){				   // <= curr==0 means end()
+      curr = lst->first;
       return *this;
     }
     curr = curr->succ; return *this;
   }
-  iterator& operator--(){	// backward
-    if(lst->end().curr == curr){	// <= curr == 0
+  basic_iterator& operator--(){	// backward
+    if(curr == 0){		// <= curr == 0 means end()
       curr = lst->last;		// go back to the last
+      // --end() is valid even for unchecked iterators, as for STL's list<Elem>
       return *this;
     }
-    else if(curr == lst->begin().curr){ // from begin(), go to the last element, not end()
+    else if(checked && curr == lst->first){ // from begin(), go to the last element, not end()
       // this behavior is the same as that of STL's iterator
       curr = lst->last;
       return *this;
@@ -483,16 +667,20 @@ public:
     curr = curr->prev; return *this;
   }
   Elem& operator*(){
-    if(curr == 0) throw runtime_error("Error in Lst<Elem>::iterator's dereference operator *. You try to dereference end() element.");
+    if(checked && curr == 0) throw runtime_error("Error in Lst<Elem>::iterator's dereference operator *. You try to dereference end() element.");
     return curr->val;}			   // dereference (*iterator)
   Link<Elem>* operator->(){return curr;}
   // This works because iterator-> is interpreted as (iterator.operator->())-> (notice another
   // arrow operator is added at the back). See my comment in operator-> in ex 10 of ch19
   
-  bool operator==(const iterator& b) const {return curr==b.curr;}
-  // I don't have to compare lst with b.lst, because if curr==b.curr, both iterators point to
-  // the same element, which must be in the same List<>
-  bool operator!=(const iterator& b) const {return !(*this==b);}
+  bool operator==(const basic_iterator& b) const {
+    if(checked && lst != b.lst)
+      throw runtime_error("Error in List<Elem>::iterator's operator ==. The 2 iterators belong to different Lists.");
+    return curr==b.curr;}
+  // Unchecked iterators don't compare lst with b.lst, because if curr==b.curr, both iterators
+  // point to the same element, which must be in the same List<>. But the 2 end() iterators of
+  // different Lists are both 0, so the checked ones catch that mistake.
+  bool operator!=(const basic_iterator& b) const {return !(*this==b);}
 };
 
 // define class const_iterator declared inside list<Elem>. This is almost just a copy of
@@ -500,28 +688,29 @@ public:
 // as lvalue, I changed the return types of operator++, --, and * to just a temporary copy
 // of the counterparts in class list<Elem>::iterator
 template<typename Elem>
-class List<Elem>::const_iterator {
+template<bool checked>
+class List<Elem>::basic_const_iterator {
 public:
   Link<Elem>* curr;		// current link
   const List<Elem>* lst;	// pointer to the list
   
-  const_iterator(const List<Elem>* llst, Link<Elem>* p) : curr{p}, lst{llst} {}
+  basic_const_iterator(const List<Elem>* llst, Link<Elem>* p) : curr{p}, lst{llst} {}
 
-  const_iterator operator++(){	 // forward
-    if(lst->end().curr == curr){				   // <= curr==0
-      curr = lst->begin().curr;
+  basic_const_iterator operator++(){	 // forward
+    if(checked && curr == 0){				   // <= curr==0 means end()
+      curr = lst->first;
       return *this;
     }
     curr = curr->succ; return *this;
   }
   // if the user tries to go past the element one past the last element, curr is nullptr? and
   // nullptr->succ; would cause segmentation fault.
-  const_iterator operator--(){	 // backward
-    if(lst->end().curr == curr){	// <= curr == 0
+  basic_const_iterator operator--(){	 // backward
+    if(curr == 0){		// <= curr == 0 means end()
       curr = lst->last;		// go back to the last
       return *this;
     }
-    else if(curr == lst->begin().curr){ // from begin(), go to the last element, not end()
+    else if(checked && curr == lst->first){ // from begin(), go to the last element, not end()
       // this behavior is the same as that of STL's iterator
       curr = lst->last;
       return *this;
@@ -529,14 +718,16 @@ public:
     curr = curr->prev; return *this;
   }
   Elem operator*()const{
-    if(curr == 0) throw runtime_error("Error in Lst<Elem>::const_iterator's dereference operator *. You try to dereference end() element.");
+    if(checked && curr == 0) throw runtime_error("Error in Lst<Elem>::const_iterator's dereference operator *. You try to dereference end() element.");
     return curr->val;
   }			   // dereference (*iterator)
   const Link<Elem>* operator->() const {return curr;}
 
-  bool operator==(const const_iterator& b) const
-  {return curr==b.curr;}
-  bool operator!=(const const_iterator& b) const {return !(*this==b);}
+  bool operator==(const basic_const_iterator& b) const {
+    if(checked && lst != b.lst)
+      throw runtime_error("Error in List<Elem>::const_iterator's operator ==. The 2 iterators belong to different Lists.");
+    return curr==b.curr;}
+  bool operator!=(const basic_const_iterator& b) const {return !(*this==b);}
 };
 
 
@@ -161,6 +161,20 @@ int main()
     cout << "lst4 = ";
     print_container(lst4);
 
+    // test the prefetching traversal helpers and compact()
+    cout << "### test for_each(), find(), accumulate(), and compact()\n";
+    lst4.for_each([](int& e){e *= 10;});
+    print_container(lst4);	// 10 20 30 40 50
+    cout << "lst4.accumulate(0)= " << lst4.accumulate(0) << endl; // 150
+    cout << "*lst4.find(30)= " << *lst4.find(30) << endl;
+    lst4.compact();		// now the 5 links are next to each other
+    lst4.push_front(0);		// a link allocated by new, before the block
+    lst4.erase(lst4.find(30));	// a link in the block
+    lst4.pop_back();		// the last link of the block
+    print_container(lst4);	// 0 10 20 40
+    p = lst4.end(); --p;
+    cout << "--lst4.end()= " << *p << endl; // 40
+
   }
   catch(exception& e){
     cerr << e.what() << endl;
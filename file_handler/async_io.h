@@ -0,0 +1,416 @@
+
+#ifndef ASYNC_IO_GUARD
+#define ASYNC_IO_GUARD 1
+
+#include "std_lib_facilities.h"
+#include<functional>
+#include<future>
+#include<thread>
+#include<mutex>
+#include<condition_variable>
+#include<deque>
+#include<memory>		// for shared_ptr
+#include<cerrno>
+#include<cstdint>		// for UINT32_MAX
+#include<unistd.h>		// for pread(), pwrite(), close() (POSIX)
+#include<sys/uio.h>		// for iovec (POSIX)
+#include<sys/mman.h>		// for mmap() (POSIX)
+#if __has_include(<linux/io_uring.h>)
+#include<linux/io_uring.h>
+#include<sys/syscall.h>
+#define ASYNC_IO_HAS_IO_URING 1
+#else
+#define ASYNC_IO_HAS_IO_URING 0
+#endif
+
+// Asynchronous reads and writes at given offsets of files, so that a thread can start many
+// of them and do other work (or start more) instead of blocking in each fread()/fwrite().
+// With a File_handle, pass fh.fileno() as fd. (The offsets are positions in the file, and
+// don't move the reading position of the FILE*.)
+// A request is queued by read() or write(), and goes to the OS at submit(), so that many
+// requests are submitted by 1 system call. Its result is what pread()/pwrite() would return:
+// the number of bytes (which can be less than requested, e.g. at the end of the file), or
+// -errno on an error. It is given to the callback, or to the future.
+// There are 2 backends:
+//  io_uring (Linux 5.6 or later): the requests are written into a ring shared with the
+//   kernel, and the kernel does them by itself. 1 thread of this object waits for the
+//   completions and calls the callbacks. I use the system calls directly, without liburing,
+//   since they are only 3.
+//  thread_pool: num_threads threads call pread()/pwrite(), for when io_uring is not
+//   available (other OS, old kernel, or disabled in a container, where io_uring_setup()
+//   fails). At most num_threads requests are done at a time.
+// The callbacks run on the threads of this object, so they should be short, and must not
+// call wait_all() or queue requests (which may wait for the callbacks).
+// The buffers must stay valid until the request completes.
+class Async_io {
+public:
+  using Callback = function<void(ssize_t)>;
+  enum class Backend {io_uring, thread_pool};
+
+  // queue_depth: the size of the ring of io_uring (and the number of requests queued at
+  // most before waiting is 2*queue_depth, for both backends)
+  explicit Async_io(unsigned queue_depth = 64, Backend preferred = Backend::io_uring,
+		    int num_threads = 4);
+  ~Async_io();			// waits for all the queued requests
+  Async_io(const Async_io&) = delete;
+  Async_io& operator=(const Async_io&) = delete;
+
+  void read(int fd, void* buf, size_t bytes, off_t offset, Callback cb)
+  {queue(Request{op_read, fd, buf, bytes, offset, -1, move(cb)});}
+  void write(int fd, const void* buf, size_t bytes, off_t offset, Callback cb)
+  {queue(Request{op_write, fd, const_cast<void*>(buf), bytes, offset, -1, move(cb)});}
+  future<ssize_t> read(int fd, void* buf, size_t bytes, off_t offset);
+  future<ssize_t> write(int fd, const void* buf, size_t bytes, off_t offset);
+
+  // Register buffers with the kernel once, so that it doesn't have to pin and map the pages
+  // of a buffer for each request. read_fixed()/write_fixed() then take the index of the
+  // registered buffer that has buf. Call this before queueing any request. With
+  // thread_pool, registering does nothing and the fixed requests are usual ones
+  void register_buffers(const vector<iovec>& bufs);
+  void read_fixed(int fd, int buf_index, void* buf, size_t bytes, off_t offset, Callback cb)
+  {queue(Request{op_read, fd, buf, bytes, offset, buf_index, move(cb)});}
+  void write_fixed(int fd, int buf_index, const void* buf, size_t bytes, off_t offset,
+		   Callback cb)
+  {queue(Request{op_write, fd, const_cast<void*>(buf), bytes, offset, buf_index, move(cb)});}
+
+  void submit();		// give the queued requests to the OS
+  void wait_all();		// submit(), and wait until all the requests complete
+
+  Backend backend() const {return use_ring ? Backend::io_uring : Backend::thread_pool;}
+
+private:
+  enum Op {op_read, op_write, op_nop};
+  struct Request {
+    Op op;
+    int fd;
+    void* buf;
+    size_t bytes;
+    off_t offset;
+    int buf_index;		// the registered buffer, or -1
+    Callback cb;
+  };
+
+  mutex m;			// for all the members below except the ring pointers
+  condition_variable done_cv;	// in_flight decreased
+  size_t in_flight{0};		// queued and not yet completed (including the callback)
+  size_t max_in_flight;
+  bool stopping{false};
+
+  void queue(Request r);
+  void submit_locked();
+  static void finish(Request* r, ssize_t result);	// call the callback, and delete r
+  void completed(size_t n);	// n requests are finished
+  static ssize_t run(const Request& r);	// pread()/pwrite() of r
+
+  // thread_pool
+  deque<Request*> pending;	// queued, not yet submitted
+  deque<Request*> work;		// submitted, not yet taken by a worker
+  condition_variable work_cv;
+  vector<thread> workers;
+  void worker_loop();
+
+  // io_uring
+  bool use_ring{false};
+  thread reaper;		// waits for the completions
+  void reaper_loop();
+#if ASYNC_IO_HAS_IO_URING
+  int ring_fd{-1};
+  void* sq_ptr{nullptr};
+  void* cq_ptr{nullptr};
+  size_t sq_bytes{0}, cq_bytes{0};
+  io_uring_sqe* sqes{nullptr};
+  size_t sqes_bytes{0};
+  unsigned *sq_head, *sq_tail, *sq_mask, *sq_array, sq_entries{0};
+  unsigned *cq_head, *cq_tail, *cq_mask;
+  io_uring_cqe* cqes;
+  unsigned unsubmitted{0};	// requests in the ring not yet given to io_uring_enter()
+
+  bool setup_ring(unsigned entries);
+  void close_ring();
+  void push_sqe(Request* r);
+  static int ring_enter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags){
+    return static_cast<int>(syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags,
+				    nullptr, 0));
+  }
+#endif
+};
+
+inline Async_io::Async_io(unsigned queue_depth, Backend preferred, int num_threads)
+  : max_in_flight{2*static_cast<size_t>(queue_depth)}
+{
+  if(queue_depth == 0 || num_threads <= 0)
+    throw runtime_error("Error in Async_io. queue_depth and num_threads must be positive.");
+#if ASYNC_IO_HAS_IO_URING
+  if(preferred == Backend::io_uring && setup_ring(queue_depth)){
+    use_ring = true;
+    reaper = thread{&Async_io::reaper_loop, this};
+    return;
+  }
+#endif
+  for(int i=0; i<num_threads; ++i)
+    workers.emplace_back(&Async_io::worker_loop, this);
+}
+
+inline Async_io::~Async_io(){
+  {
+    unique_lock<mutex> lk{m};
+    stopping = true;
+#if ASYNC_IO_HAS_IO_URING
+    if(use_ring){
+      // a no-op request wakes the reaper up, which then sees stopping, and stops after the
+      // last completion
+      if(in_flight == max_in_flight){
+	submit_locked();
+	done_cv.wait(lk, [this]{return in_flight < max_in_flight;});
+      }
+      ++in_flight;
+      push_sqe(new Request{op_nop, -1, nullptr, 0, 0, -1, nullptr});
+    }
+#endif
+    submit_locked();
+  }
+  work_cv.notify_all();
+  if(reaper.joinable())
+    reaper.join();
+  for(thread& t : workers)
+    t.join();
+#if ASYNC_IO_HAS_IO_URING
+  close_ring();
+#endif
+}
+
+inline future<ssize_t> Async_io::read(int fd, void* buf, size_t bytes, off_t offset){
+  auto p = make_shared<promise<ssize_t>>();
+  future<ssize_t> f{p->get_future()};
+  read(fd, buf, bytes, offset, [p](ssize_t r){p->set_value(r);});
+  return f;
+}
+
+inline future<ssize_t> Async_io::write(int fd, const void* buf, size_t bytes, off_t offset){
+  auto p = make_shared<promise<ssize_t>>();
+  future<ssize_t> f{p->get_future()};
+  write(fd, buf, bytes, offset, [p](ssize_t r){p->set_value(r);});
+  return f;
+}
+
+inline void Async_io::queue(Request r){
+  Request* rp{new Request{move(r)}};
+  unique_lock<mutex> lk{m};
+  if(in_flight == max_in_flight){
+    // the queued requests must be submitted, or they never complete
+    submit_locked();
+    work_cv.notify_all();
+    done_cv.wait(lk, [this]{return in_flight < max_in_flight;});
+  }
+  ++in_flight;
+#if ASYNC_IO_HAS_IO_URING
+  if(use_ring){
+    push_sqe(rp);
+    return;
+  }
+#endif
+  pending.push_back(rp);
+}
+
+inline void Async_io::submit(){
+  {
+    lock_guard<mutex> lk{m};
+    submit_locked();
+  }
+  work_cv.notify_all();
+}
+
+inline void Async_io::submit_locked(){
+#if ASYNC_IO_HAS_IO_URING
+  if(use_ring){
+    while(unsubmitted > 0){
+      int n{ring_enter(ring_fd, unsubmitted, 0, 0)};
+      if(n < 0){
+	if(errno == EINTR || errno == EAGAIN)
+	  continue;
+	throw runtime_error("Error in Async_io::submit(). io_uring_enter() failed.");
+      }
+      unsubmitted -= n;
+    }
+    return;
+  }
+#endif
+  work.insert(work.end(), pending.begin(), pending.end());
+  pending.clear();
+}
+
+inline void Async_io::wait_all(){
+  submit();
+  unique_lock<mutex> lk{m};
+  done_cv.wait(lk, [this]{return in_flight == 0;});
+}
+
+inline void Async_io::finish(Request* r, ssize_t result){
+  if(r->cb)
+    r->cb(result);
+  delete r;
+}
+
+inline void Async_io::completed(size_t n){
+  {
+    lock_guard<mutex> lk{m};
+    in_flight -= n;
+  }
+  done_cv.notify_all();
+}
+
+inline ssize_t Async_io::run(const Request& r){
+  ssize_t n{r.op == op_read ? pread(r.fd, r.buf, r.bytes, r.offset)
+      : pwrite(r.fd, r.buf, r.bytes, r.offset)};
+  return n < 0 ? -errno : n;
+}
+
+inline void Async_io::worker_loop(){
+  while(true){
+    Request* r;
+    {
+      unique_lock<mutex> lk{m};
+      work_cv.wait(lk, [this]{return !work.empty() || stopping;});
+      if(work.empty())
+	return;			// stopping, and nothing left
+      r = work.front();
+      work.pop_front();
+    }
+    finish(r, run(*r));
+    completed(1);
+  }
+}
+
+inline void Async_io::register_buffers(const vector<iovec>& bufs){
+#if ASYNC_IO_HAS_IO_URING
+  if(use_ring && syscall(__NR_io_uring_register, ring_fd, IORING_REGISTER_BUFFERS, bufs.data(),
+			 static_cast<unsigned>(bufs.size())) < 0)
+    throw runtime_error("Error in Async_io::register_buffers(). The buffers cannot be registered"
+			" (the limit of locked memory, ulimit -l, may be too small).");
+#endif
+  (void)bufs;
+}
+
+#if ASYNC_IO_HAS_IO_URING
+// map the 2 rings and the array of the requests (sqes) shared with the kernel
+inline bool Async_io::setup_ring(unsigned entries){
+  io_uring_params p{};
+  ring_fd = static_cast<int>(syscall(__NR_io_uring_setup, entries, &p));
+  if(ring_fd < 0)
+    return false;
+  sq_bytes = p.sq_off.array + p.sq_entries*sizeof(unsigned);
+  cq_bytes = p.cq_off.cqes + p.cq_entries*sizeof(io_uring_cqe);
+  bool single{(p.features & IORING_FEAT_SINGLE_MMAP) != 0}; // both rings in 1 mapping
+  if(single)
+    sq_bytes = cq_bytes = max(sq_bytes, cq_bytes);
+  sq_ptr = mmap(nullptr, sq_bytes, PROT_READ|PROT_WRITE, MAP_SHARED|MAP_POPULATE, ring_fd,
+		IORING_OFF_SQ_RING);
+  if(sq_ptr == MAP_FAILED){
+    sq_ptr = nullptr;
+    close_ring();
+    return false;
+  }
+  cq_ptr = single ? sq_ptr : mmap(nullptr, cq_bytes, PROT_READ|PROT_WRITE,
+				  MAP_SHARED|MAP_POPULATE, ring_fd, IORING_OFF_CQ_RING);
+  sqes_bytes = p.sq_entries*sizeof(io_uring_sqe);
+  void* s{mmap(nullptr, sqes_bytes, PROT_READ|PROT_WRITE, MAP_SHARED|MAP_POPULATE, ring_fd,
+	       IORING_OFF_SQES)};
+  if(cq_ptr == MAP_FAILED || s == MAP_FAILED){
+    if(cq_ptr == MAP_FAILED)
+      cq_ptr = nullptr;
+    if(s != MAP_FAILED)
+      munmap(s, sqes_bytes);
+    close_ring();
+    return false;
+  }
+  sqes = static_cast<io_uring_sqe*>(s);
+  char* sq{static_cast<char*>(sq_ptr)};
+  sq_head = reinterpret_cast<unsigned*>(sq + p.sq_off.head);
+  sq_tail = reinterpret_cast<unsigned*>(sq + p.sq_off.tail);
+  sq_mask = reinterpret_cast<unsigned*>(sq + p.sq_off.ring_mask);
+  sq_array = reinterpret_cast<unsigned*>(sq + p.sq_off.array);
+  sq_entries = p.sq_entries;
+  char* cq{static_cast<char*>(cq_ptr)};
+  cq_head = reinterpret_cast<unsigned*>(cq + p.cq_off.head);
+  cq_tail = reinterpret_cast<unsigned*>(cq + p.cq_off.tail);
+  cq_mask = reinterpret_cast<unsigned*>(cq + p.cq_off.ring_mask);
+  cqes = reinterpret_cast<io_uring_cqe*>(cq + p.cq_off.cqes);
+  // the completion ring has room for all the requests in flight, so no completion is lost
+  max_in_flight = min(max_in_flight, static_cast<size_t>(p.cq_entries));
+  return true;
+}
+
+inline void Async_io::close_ring(){
+  if(sqes)
+    munmap(sqes, sqes_bytes);
+  if(cq_ptr && cq_ptr != sq_ptr)
+    munmap(cq_ptr, cq_bytes);
+  if(sq_ptr)
+    munmap(sq_ptr, sq_bytes);
+  if(ring_fd >= 0)
+    close(ring_fd);
+  sqes = nullptr;
+  sq_ptr = cq_ptr = nullptr;
+  ring_fd = -1;
+}
+
+// write r into the next free entry of the submission ring (m must be locked). The kernel
+// reads the entries up to *sq_tail, so the entry is written before the tail moves
+inline void Async_io::push_sqe(Request* r){
+  unsigned tail{*sq_tail};	// only this object writes the tail
+  if(tail - __atomic_load_n(sq_head, __ATOMIC_ACQUIRE) == sq_entries){
+    submit_locked();		// the kernel takes the entries in io_uring_enter()
+    tail = *sq_tail;
+  }
+  unsigned i{tail & *sq_mask};
+  io_uring_sqe& e{sqes[i]};
+  e = io_uring_sqe{};
+  bool fixed{r->buf_index >= 0};
+  e.opcode = r->op == op_nop ? IORING_OP_NOP
+    : r->op == op_read ? (fixed ? IORING_OP_READ_FIXED : IORING_OP_READ)
+    : (fixed ? IORING_OP_WRITE_FIXED : IORING_OP_WRITE);
+  e.fd = r->fd;
+  e.addr = reinterpret_cast<uint64_t>(r->buf);
+  // the length of an entry is 32 bits, so a request of 4GB or more is cut to UINT32_MAX bytes,
+  // and its result is a short count, as pread() gives (Linux itself reads or writes at most
+  // about 2GB at a time). A plain cast would wrap, e.g. 4GB to 0 bytes, which looks like EOF
+  e.len = static_cast<uint32_t>(min<size_t>(r->bytes, UINT32_MAX));
+  e.off = static_cast<uint64_t>(r->offset);
+  if(fixed)
+    e.buf_index = static_cast<uint16_t>(r->buf_index);
+  e.user_data = reinterpret_cast<uint64_t>(r);	// comes back in the completion
+  sq_array[i] = i;
+  __atomic_store_n(sq_tail, tail + 1, __ATOMIC_RELEASE);
+  ++unsubmitted;
+}
+
+// take the completions from the completion ring, and wait for more in io_uring_enter()
+inline void Async_io::reaper_loop(){
+  while(true){
+    unsigned head{*cq_head};	// only this thread writes the head
+    size_t n{0};
+    while(head != __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE)){
+      const io_uring_cqe& c{cqes[head & *cq_mask]};
+      Request* r{reinterpret_cast<Request*>(c.user_data)};
+      ssize_t result{c.res};
+      __atomic_store_n(cq_head, ++head, __ATOMIC_RELEASE);  // the entry can be reused
+      finish(r, result);
+      ++n;
+    }
+    // in_flight is decreased once for all the completions taken, to lock m only once
+    if(n > 0)
+      completed(n);
+    {
+      lock_guard<mutex> lk{m};
+      if(stopping && in_flight == 0)
+	return;
+    }
+    // returns at once if a completion came after the loop above
+    ring_enter(ring_fd, 0, 1, IORING_ENTER_GETEVENTS);
+  }
+}
+#else
+inline void Async_io::reaper_loop(){}
+#endif
+
+#endif // ASYNC_IO_GUARD
@@ -0,0 +1,136 @@
+
+// Benchmark of Async_io: random reads of 4KB from a file, by pread() 1 at a time, and by
+// Async_io with the thread_pool and the io_uring backends, queue_depth reads at a time (each
+// batch is submitted by 1 call, and waited by wait_all()), in reads/s and MB/s.
+// usage: ./bench_async_io [file size in MB] [number of reads] [file name] [queue depth] [direct]
+// e.g. ./bench_async_io 256 200000 /dev/shm/bench_async_io.bin (tmpfs)
+//      ./bench_async_io 1024 20000 bench_async_io.bin 64 direct (ext4, bypassing the page cache)
+// With "direct", the file is opened with O_DIRECT, so each read goes to the disk, and the
+// reads in flight at the same time overlap in the disk. Without it, the reads are copies
+// from the page cache, and this measures the cost of each request.
+// The file is removed at the end.
+
+#include "std_lib_facilities.h"
+#include "file_handle.h"
+#include "async_io.h"
+#include<chrono>
+#include<cstdio>		// for remove()
+#include<cstdlib>		// for aligned_alloc()
+#include<fcntl.h>		// for open() (POSIX)
+
+double seconds_since(chrono::steady_clock::time_point t0){
+  return chrono::duration<double>(chrono::steady_clock::now()-t0).count();
+}
+
+constexpr size_t block{4096};
+
+void report(const string& label, size_t reads, double sec){
+  cout << label << ": " << reads/sec << " reads/s, " << reads*block/1e6/sec << " MB/s\n";
+}
+
+// the reads of offsets by io (registered buffers if fixed), depth at a time into bufs
+unsigned long run_async(Async_io& io, int fd, const vector<off_t>& offsets,
+			const vector<char*>& bufs, bool fixed){
+  size_t depth{bufs.size()};
+  unsigned long check{0};
+  atomic<size_t> errors{0};
+  for(size_t i=0; i<offsets.size(); i += depth){
+    size_t n{min(depth, offsets.size() - i)};
+    for(size_t j=0; j<n; ++j){
+      auto cb = [&errors](ssize_t r){if(r != static_cast<ssize_t>(block)) ++errors;};
+      if(fixed)
+	io.read_fixed(fd, static_cast<int>(j), bufs[j], block, offsets[i+j], cb);
+      else
+	io.read(fd, bufs[j], block, offsets[i+j], cb);
+    }
+    io.wait_all();
+    for(size_t j=0; j<n; ++j)
+      check += static_cast<unsigned char>(bufs[j][0]);
+  }
+  if(errors > 0)
+    error("a read of Async_io failed");
+  return check;
+}
+
+int main(int argc, char* argv[])
+  try{
+    size_t mb{argc>1 ? stoul(argv[1]) : 256};
+    size_t num_reads{argc>2 ? stoul(argv[2]) : 200000};
+    string fn{argc>3 ? argv[3] : "/dev/shm/bench_async_io.bin"};
+    size_t depth{argc>4 ? stoul(argv[4]) : 64};
+    bool direct{argc>5 && string{argv[5]} == "direct"};
+
+    {
+      File_handle fh{fn, "wb", 1<<20};
+      vector<char> data(1<<20);
+      mt19937 rng{3};
+      for(size_t i=0; i<mb; ++i){
+	for(char& c : data)
+	  c = static_cast<char>(rng());
+	fh.write_all(data.data(), data.size());
+      }
+    }
+    int fd{open(fn.c_str(), O_RDONLY | (direct ? O_DIRECT : 0))};
+    if(fd < 0)
+      error("cannot open " + fn + (direct ? " with O_DIRECT (tmpfs doesn't support it)" : ""));
+
+    mt19937_64 rng{5};
+    vector<off_t> offsets(num_reads);
+    for(off_t& o : offsets)
+      o = static_cast<off_t>(rng() % ((mb << 20)/block) * block);
+    vector<char*> bufs(depth);	// aligned to 4KB for O_DIRECT
+    vector<iovec> iovs(depth);
+    for(size_t j=0; j<depth; ++j){
+      bufs[j] = static_cast<char*>(aligned_alloc(block, block));
+      iovs[j] = iovec{bufs[j], block};
+    }
+    cout << "file: " << mb << " MB (" << fn << (direct ? ", O_DIRECT" : "") << "), "
+	 << num_reads << " reads of 4KB, queue depth " << depth << '\n';
+    unsigned long check{0};
+
+    auto t0 = chrono::steady_clock::now();
+    for(off_t o : offsets){
+      if(pread(fd, bufs[0], block, o) != static_cast<ssize_t>(block))
+	error("pread() failed");
+      check += static_cast<unsigned char>(bufs[0][0]);
+    }
+    report("pread() 1 at a time             ", num_reads, seconds_since(t0));
+
+    for(int threads : {4, 16}){
+      Async_io io{static_cast<unsigned>(depth), Async_io::Backend::thread_pool, threads};
+      t0 = chrono::steady_clock::now();
+      check += run_async(io, fd, offsets, bufs, false);
+      report("Async_io thread_pool, " + to_string(threads) + " threads" + (threads<10 ? " " : ""),
+	     num_reads, seconds_since(t0));
+    }
+    {
+      Async_io io{static_cast<unsigned>(depth)};
+      if(io.backend() != Async_io::Backend::io_uring)
+	cout << "io_uring is not available here, so the rest is the thread_pool\n";
+      t0 = chrono::steady_clock::now();
+      check += run_async(io, fd, offsets, bufs, false);
+      report("Async_io io_uring               ", num_reads, seconds_since(t0));
+    }
+    {
+      Async_io io{static_cast<unsigned>(depth)};
+      io.register_buffers(iovs);
+      t0 = chrono::steady_clock::now();
+      check += run_async(io, fd, offsets, bufs, true);
+      report("Async_io io_uring, registered   ", num_reads, seconds_since(t0));
+    }
+    cout << "(checksum " << check << ")\n";
+
+    for(char* b : bufs)
+      free(b);
+    close(fd);
+    remove(fn.c_str());
+    return 0;
+  }
+  catch(exception& e){
+    cerr << e.what() << endl;
+    return 1;
+  }
+  catch(...){
+    cerr << "Unknown error happens\n";
+    return 1;
+  }
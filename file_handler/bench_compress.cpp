@@ -0,0 +1,122 @@
+
+// Benchmark of Compressed_writer/Compressed_reader against writing the raw bytes by
+// File_handle: the end-to-end time of writing a log-like text file until it is on the disk
+// (fdatasync()), the compression ratio and speed of each codec, and the decompression speed
+// with 1 and more threads.
+// usage: ./bench_compress [size in MB] [file name] [threads to decompress]
+// The codecs other than Lz_codec are included by CODECS of the makefile, e.g.
+//   make bench_compress CODECS="-DUSE_ZLIB -lz"
+// The files are removed at the end.
+
+#include "std_lib_facilities.h"
+#include "file_handle.h"
+#include "compressed_file.h"
+#include<chrono>
+#include<cstdio>		// for remove()
+#include<fcntl.h>		// for open() (POSIX)
+
+double seconds_since(chrono::steady_clock::time_point t0){
+  return chrono::duration<double>(chrono::steady_clock::now()-t0).count();
+}
+
+// write the dirty pages of fn to the disk
+void sync_file(const string& fn){
+  int fd{open(fn.c_str(), O_RDONLY)};
+  if(fd < 0 || fdatasync(fd) != 0)
+    error("cannot sync " + fn);
+  close(fd);
+}
+
+// about mb MB of lines like a log of a server, which compress well
+string make_log(size_t mb){
+  const char* levels[]{"INFO", "INFO", "INFO", "DEBUG", "WARN", "ERROR"};
+  const char* events[]{"request handled", "cache miss", "connection opened",
+		       "connection closed", "retrying upstream", "slow query"};
+  mt19937 rng{21};
+  string s;
+  s.reserve((mb << 20) + 200);
+  long long t{1700000000000};
+  while(s.size() < (mb << 20)){
+    t += rng()%50;
+    s += "2024-05-01T12:" + to_string(t/60000%60) + ":" + to_string(t/1000%60) + "."
+      + to_string(t%1000) + " " + levels[rng()%6] + " worker-" + to_string(rng()%16) + " "
+      + events[rng()%6] + " id=" + to_string(rng()%100000) + " latency_us="
+      + to_string(rng()%5000) + "\n";
+  }
+  return s;
+}
+
+void run(const Codec& c, const string& fn, const string& data, double raw_write, int threads){
+  const size_t piece{1<<16};	// written as the program would, a piece at a time
+  auto t0 = chrono::steady_clock::now();
+  uint64_t file_bytes;
+  {
+    Compressed_writer w{fn, c};
+    for(size_t i=0; i<data.size(); i+=piece)
+      w.write(data.data() + i, min(piece, data.size() - i));
+    w.finish();
+    file_bytes = w.file_bytes();
+  }
+  sync_file(fn);
+  double write{seconds_since(t0)};
+  double mb{data.size()/1e6};
+  cout << c.name() << ": ratio " << double(data.size())/file_bytes << ", write+sync "
+       << write << " s (raw " << raw_write << " s), " << mb/write << " MB/s of raw bytes\n";
+
+  for(int th : {1, threads}){
+    Compressed_reader r{fn};
+    t0 = chrono::steady_clock::now();
+    vector<char> back{r.read_all(th)};
+    double read{seconds_since(t0)};
+    if(back.size() != data.size() || memcmp(back.data(), data.data(), data.size()) != 0)
+      error("the decompressed bytes are different by " + c.name());
+    cout << "  read_all(" << th << " thread" << (th>1 ? "s" : "") << "): " << mb/read
+	 << " MB/s of raw bytes, " << r.blocks() << " blocks\n";
+    if(th == threads)
+      break;
+  }
+}
+
+int main(int argc, char* argv[])
+  try{
+    size_t mb{argc>1 ? stoul(argv[1]) : 256};
+    string fn{argc>2 ? argv[2] : "bench_compress.bin"};
+    int threads{argc>3 ? stoi(argv[3]) : 4};
+    string data{make_log(mb)};
+    cout << "data: " << data.size()/1e6 << " MB of log lines (" << fn << ")\n";
+
+    auto t0 = chrono::steady_clock::now();
+    {
+      File_handle fh{fn, "wb"};
+      for(size_t i=0; i<data.size(); i+=1<<16)
+	fh.write_all(data.data() + i, min(size_t{1<<16}, data.size() - i));
+    }
+    sync_file(fn);
+    double raw_write{seconds_since(t0)};
+    cout << "raw File_handle: write+sync " << raw_write << " s, " << data.size()/1e6/raw_write
+	 << " MB/s\n";
+
+    run(Lz_codec{}, fn, data, raw_write, threads);
+#if defined(USE_LZ4)
+    run(Lz4_codec{}, fn, data, raw_write, threads);
+#endif
+#if defined(USE_ZSTD)
+    run(Zstd_codec{1}, fn, data, raw_write, threads);
+    run(Zstd_codec{3}, fn, data, raw_write, threads);
+#endif
+#if defined(USE_ZLIB)
+    run(Zlib_codec{1}, fn, data, raw_write, threads);
+    run(Zlib_codec{6}, fn, data, raw_write, threads);
+#endif
+
+    remove(fn.c_str());
+    return 0;
+  }
+  catch(exception& e){
+    cerr << e.what() << endl;
+    return 1;
+  }
+  catch(...){
+    cerr << "Unknown error happens\n";
+    return 1;
+  }
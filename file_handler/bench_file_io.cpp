@@ -0,0 +1,111 @@
+
+// Benchmark of File_handle: reading and writing a file in MB/s with operations of 1 byte
+// (fgetc()/fputc()), 4KB and 1MB (fread()/fwrite()), with the default buffer of stdio and
+// with a 1MB buffer (the buffer_bytes of the constructor), against the old fread() which read
+// into a char array on the stack and copied it to the destination byte by byte.
+// usage: ./bench_file_io [file size in MB] [file name]
+// The file is removed at the end. Reading right after writing mostly reads the page cache,
+// so the numbers are the cost of the library and of the system calls, not of the disk.
+
+#include "std_lib_facilities.h"
+#include "file_handle.h"
+#include<chrono>
+#include<cstdio>		// for remove()
+
+double seconds_since(chrono::steady_clock::time_point t0){
+  return chrono::duration<double>(chrono::steady_clock::now()-t0).count();
+}
+
+// the fread() of File_handle before it read directly into the destination
+size_t old_fread(FILE* f, void* var_ptr, size_t read_bytes){
+  char buf[read_bytes];
+  size_t read_size{::fread(buf, 1, read_bytes, f)};
+  if(ferror(f))
+    throw runtime_error("Error in old_fread().");
+  char* dst{static_cast<char*>(var_ptr)};
+  for(size_t i=0; i<read_size; ++i)
+    dst[i] = buf[i];
+  return read_size;
+}
+
+void report(const string& label, size_t bytes, double sec){
+  cout << label << ": " << bytes/1e6/sec << " MB/s\n";
+}
+
+// write bytes bytes to fn in pieces of piece bytes (1 byte by fputc())
+void write_file(const string& fn, size_t bytes, size_t piece, size_t buffer_bytes,
+		const vector<char>& data){
+  File_handle fh{fn, "wb", buffer_bytes};
+  if(piece == 1)
+    for(size_t i=0; i<bytes; ++i)
+      fh.fputc(data[i % data.size()]);
+  else
+    for(size_t done{0}; done < bytes; done += piece)
+      fh.write_all(data.data(), min(piece, bytes - done));
+}
+
+// read fn in pieces of piece bytes (1 byte by fgetc()), and return a checksum
+unsigned long read_file(const string& fn, size_t bytes, size_t piece, size_t buffer_bytes,
+			vector<char>& buf, bool old = false){
+  File_handle fh{fn, "rb", buffer_bytes};
+  unsigned long check{0};
+  if(piece == 1){
+    for(size_t i=0; i<bytes; ++i)
+      check += static_cast<unsigned char>(fh.fgetc());
+    return check;
+  }
+  FILE* f{old? fopen(fn.c_str(), "rb") : nullptr};
+  for(size_t n; (n = old? old_fread(f, buf.data(), piece) : fh.fread(buf.data(), piece)) > 0; )
+    check += static_cast<unsigned char>(buf[n-1]);
+  if(f) fclose(f);
+  return check;
+}
+
+int main(int argc, char* argv[])
+  try{
+    size_t mb{argc>1 ? stoul(argv[1]) : 256};
+    string fn{argc>2 ? argv[2] : "bench_file_io.bin"};
+    size_t bytes{mb << 20};
+    vector<char> data(1<<20);
+    mt19937 rng{7};
+    for(char& c : data)
+      c = static_cast<char>(rng());
+    vector<char> buf(1<<20);
+    unsigned long check{0};
+    cout << "file: " << mb << " MB (" << fn << ")\n";
+
+    const size_t pieces[]{1, 4096, 1<<20};
+    const string names[]{"1 byte", "4KB   ", "1MB   "};
+    for(size_t buffer_bytes : {size_t{0}, size_t{1<<20}}){
+      string b{buffer_bytes? "1MB buffer    " : "default buffer"};
+      for(int i=0; i<3; ++i){
+	auto t0 = chrono::steady_clock::now();
+	write_file(fn, bytes, pieces[i], buffer_bytes, data);
+	report("write " + names[i] + ", " + b, bytes, seconds_since(t0));
+      }
+      for(int i=0; i<3; ++i){
+	auto t0 = chrono::steady_clock::now();
+	check += read_file(fn, bytes, pieces[i], buffer_bytes, buf);
+	report("read  " + names[i] + ", " + b, bytes, seconds_since(t0));
+      }
+    }
+    // the old fread() with 1MB needs a 1MB array on the stack, which is within the usual 8MB
+    // limit, but a request of more than 8MB crashed it
+    for(int i=1; i<3; ++i){
+      auto t0 = chrono::steady_clock::now();
+      check += read_file(fn, bytes, pieces[i], 0, buf, true);
+      report("read  " + names[i] + ", old fread()   ", bytes, seconds_since(t0));
+    }
+    cout << "(checksum " << check << ")\n";
+
+    remove(fn.c_str());
+    return 0;
+  }
+  catch(exception& e){
+    cerr << e.what() << endl;
+    return 1;
+  }
+  catch(...){
+    cerr << "Unknown error happens\n";
+    return 1;
+  }
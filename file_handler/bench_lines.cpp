@@ -0,0 +1,108 @@
+
+// Benchmark of scanning a text file line by line with File_handle: fgets() through the
+// buffer of the FILE*, fgets() served from the mapping (mode "rm"), Line_reader (string_view
+// of each line) on both, and memchr() over the mapped bytes() directly, in MB/s and lines/s.
+// usage: ./bench_lines [file size in MB] [file name]
+// The file is made of lines of 20 to 120 random letters, and removed at the end. Reading right
+// after writing mostly reads the page cache, so this measures the copying, not the disk.
+
+#include "std_lib_facilities.h"
+#include "file_handle.h"
+#include "line_reader.h"
+#include<chrono>
+#include<cstdio>		// for remove()
+
+double seconds_since(chrono::steady_clock::time_point t0){
+  return chrono::duration<double>(chrono::steady_clock::now()-t0).count();
+}
+
+// write a file of about mb MB of lines, and return the number of lines
+size_t make_file(const string& fn, size_t mb){
+  File_handle fh{fn, "wb", 1<<20};
+  mt19937 rng{11};
+  string line;
+  size_t bytes{0}, lines{0};
+  while(bytes < (mb << 20)){
+    line.assign(20 + rng()%101, 'a');
+    for(char& c : line)
+      c = 'a' + rng()%26;
+    line += '\n';
+    fh.write_all(line.data(), line.size());
+    bytes += line.size();
+    ++lines;
+  }
+  return lines;
+}
+
+void report(const string& label, size_t bytes, size_t lines, double sec){
+  cout << label << ": " << bytes/1e6/sec << " MB/s, " << lines/1e6/sec << " M lines/s\n";
+}
+
+// count the lines and the bytes by fgets() of File_handle opened with mode
+void scan_fgets(const string& label, const string& fn, const string& mode, size_t lines){
+  auto t0 = chrono::steady_clock::now();
+  File_handle fh{fn, mode};
+  string s;
+  size_t n{0}, bytes{0};
+  for(fh.fgets(s, 4096); s != "EOF"; fh.fgets(s, 4096)){
+    bytes += s.size();
+    if(s.back() == '\n')
+      ++n;
+  }
+  double sec{seconds_since(t0)};
+  if(n != lines)
+    error("wrong number of lines by " + label);
+  report(label, bytes, n, sec);
+}
+
+// count the lines and the bytes by Line_reader of File_handle opened with mode
+void scan_reader(const string& label, const string& fn, const string& mode, size_t lines){
+  auto t0 = chrono::steady_clock::now();
+  File_handle fh{fn, mode};
+  size_t bytes{0};
+  Line_reader lr{fh};
+  for(string_view line : lr)
+    bytes += line.size() + 1;
+  double sec{seconds_since(t0)};
+  if(lr.line_number() != lines)
+    error("wrong number of lines by " + label);
+  report(label, bytes, lines, sec);
+}
+
+int main(int argc, char* argv[])
+  try{
+    size_t mb{argc>1 ? stoul(argv[1]) : 512};
+    string fn{argc>2 ? argv[2] : "bench_lines.txt"};
+    size_t lines{make_file(fn, mb)};
+    cout << "file: " << mb << " MB, " << lines << " lines (" << fn << ")\n";
+
+    scan_fgets("fgets(), buffered (\"r\")      ", fn, "r", lines);
+    scan_fgets("fgets(), mapped (\"rm\")       ", fn, "rm", lines);
+    scan_reader("Line_reader, buffered (\"r\")  ", fn, "r", lines);
+    scan_reader("Line_reader, mapped (\"rm\")   ", fn, "rm", lines);
+
+    {
+      auto t0 = chrono::steady_clock::now();
+      File_handle fh{fn, "rm"};
+      Byte_span b{fh.bytes()};
+      size_t n{0};
+      for(const unsigned char* p{b.begin()};
+	  (p = static_cast<const unsigned char*>(memchr(p, '\n', b.end() - p))) != nullptr; ++p)
+	++n;
+      double sec{seconds_since(t0)};
+      if(n != lines)
+	error("wrong number of lines by memchr()");
+      report("memchr() over bytes() (\"rm\")", b.size(), n, sec);
+    }
+
+    remove(fn.c_str());
+    return 0;
+  }
+  catch(exception& e){
+    cerr << e.what() << endl;
+    return 1;
+  }
+  catch(...){
+    cerr << "Unknown error happens\n";
+    return 1;
+  }
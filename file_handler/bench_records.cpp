@@ -0,0 +1,132 @@
+
+// Benchmark of writing and reading an array of structs: field by field with
+// File_handle::fwrite()/fread() (as main() does with single values), against write_array()/
+// read_array() of record_io.h with vector<T>, Vector<T> (My_Allocator) and Vector3<T>
+// (Vector3), in records/s, and the speed of crc32c() alone.
+// usage: ./bench_records [number of records] [file name]
+// The file is removed at the end. Reading right after writing mostly reads the page cache.
+
+#include "std_lib_facilities.h"
+#include "file_handle.h"
+#include "record_io.h"
+#include "../My_Allocator/Vector.h"
+#include "../Vector3/vector3.h"
+#include<chrono>
+#include<cstdio>		// for remove()
+
+double seconds_since(chrono::steady_clock::time_point t0){
+  return chrono::duration<double>(chrono::steady_clock::now()-t0).count();
+}
+
+struct Particle {		// 32 bytes
+  double x, y, z;
+  float mass;
+  int id;
+};
+
+void report(const string& label, size_t n, double write, double read){
+  cout << label << ": write " << n/1e6/write << " M records/s (" << n*sizeof(Particle)/1e6/write
+       << " MB/s), read " << n/1e6/read << " M records/s (" << n*sizeof(Particle)/1e6/read
+       << " MB/s)\n";
+}
+
+void check_same(const Particle* a, const Particle* b, size_t n){
+  for(size_t i=0; i<n; ++i)
+    if(a[i].x != b[i].x || a[i].mass != b[i].mass || a[i].id != b[i].id)
+      error("the read records are different from the written ones");
+}
+
+// write and read src through a container of type C
+template<typename C>
+void run_container(const string& label, const string& fn, const vector<Particle>& src){
+  int n{static_cast<int>(src.size())};
+  C c(n);
+  for(int i=0; i<n; ++i)
+    c[i] = src[i];
+  auto t0 = chrono::steady_clock::now();
+  {
+    File_handle fh{fn, "wb"};
+    write_array(fh, c);
+  }
+  double write{seconds_since(t0)};
+  C d;
+  t0 = chrono::steady_clock::now();
+  {
+    File_handle fh{fn, "rb"};
+    read_array(fh, d);
+  }
+  double read{seconds_since(t0)};
+  if(static_cast<size_t>(d.size()) != src.size())
+    error("wrong number of records");
+  check_same(src.data(), d.data(), src.size());
+  report(label, src.size(), write, read);
+}
+
+int main(int argc, char* argv[])
+  try{
+    size_t n{argc>1 ? stoul(argv[1]) : 5000000};
+    string fn{argc>2 ? argv[2] : "bench_records.bin"};
+    vector<Particle> src(n);
+    mt19937 rng{9};
+    uniform_real_distribution<double> u{-1, 1};
+    for(size_t i=0; i<n; ++i)
+      src[i] = Particle{u(rng), u(rng), u(rng), static_cast<float>(u(rng)+1), static_cast<int>(i)};
+    cout << "records: " << n << " of " << sizeof(Particle) << " bytes ("
+	 << n*sizeof(Particle)/1e6 << " MB, " << fn << ")\n";
+
+    {
+      auto t0 = chrono::steady_clock::now();
+      {
+	File_handle fh{fn, "wb"};
+	for(const Particle& p : src){
+	  fh.fwrite(&p.x, sizeof(p.x));
+	  fh.fwrite(&p.y, sizeof(p.y));
+	  fh.fwrite(&p.z, sizeof(p.z));
+	  fh.fwrite(&p.mass, sizeof(p.mass));
+	  fh.fwrite(&p.id, sizeof(p.id));
+	}
+      }
+      double write{seconds_since(t0)};
+      vector<Particle> dst(n);
+      t0 = chrono::steady_clock::now();
+      {
+	File_handle fh{fn, "rb"};
+	for(Particle& p : dst){
+	  fh.fread(&p.x, sizeof(p.x));
+	  fh.fread(&p.y, sizeof(p.y));
+	  fh.fread(&p.z, sizeof(p.z));
+	  fh.fread(&p.mass, sizeof(p.mass));
+	  fh.fread(&p.id, sizeof(p.id));
+	}
+      }
+      double read{seconds_since(t0)};
+      check_same(src.data(), dst.data(), n);
+      report("field by field fwrite()/fread()", n, write, read);
+    }
+
+    run_container<vector<Particle>>("write_array(), vector<T>       ", fn, src);
+    run_container<Vector<Particle>>("write_array(), Vector<T>       ", fn, src);
+    run_container<Vector3<Particle>>("write_array(), Vector3<T>      ", fn, src);
+
+    auto t0 = chrono::steady_clock::now();
+    uint32_t c{crc32c(src.data(), n*sizeof(Particle))};
+    double sec{seconds_since(t0)};
+    cout << "crc32c() alone: " << n*sizeof(Particle)/1e6/sec << " MB/s ("
+#if defined(__SSE4_2__)
+	 << "SSE4.2"
+#else
+	 << "slicing-by-8"
+#endif
+	 << ", crc " << hex << c << dec << ")\n";
+
+    remove(fn.c_str());
+    return 0;
+  }
+  catch(exception& e){
+    cerr << e.what() << endl;
+    return 1;
+  }
+  catch(...){
+    cerr << "Unknown error happens\n";
+    return 1;
+  }
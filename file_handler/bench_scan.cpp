@@ -0,0 +1,128 @@
+
+// Benchmark of scan_lines() (line_scanner.h) with 1 thread up to all the cores, against
+// Line_reader on 1 thread, in lines/s and MB/s. Two kinds of work per line: counting the lines
+// and their bytes (almost only finding the '\n'), and "grep" (the lines that have a word,
+// kept in order). Both reading by pread() ("rb") and slicing the mapping ("rm").
+// usage: ./bench_scan [file size in MB] [file name] [max threads]
+// The file is made of lines of 20 to 120 random words, and removed at the end. Reading right
+// after writing mostly reads the page cache, if the file fits in the memory.
+
+#include "std_lib_facilities.h"
+#include "file_handle.h"
+#include "line_reader.h"
+#include "line_scanner.h"
+#include<chrono>
+#include<cstdio>		// for remove()
+
+double seconds_since(chrono::steady_clock::time_point t0){
+  return chrono::duration<double>(chrono::steady_clock::now()-t0).count();
+}
+
+// write a file of about mb MB of lines, and return the number of lines
+size_t make_file(const string& fn, size_t mb){
+  const char* words[]{"alpha", "beta", "gamma", "delta", "epsilon", "zeta", "eta", "theta",
+		      "iota", "kappa", "lambda", "mu", "nu", "xi", "omicron", "pi"};
+  File_handle fh{fn, "wb", 1<<20};
+  mt19937 rng{13};
+  string line;
+  size_t bytes{0}, lines{0};
+  while(bytes < (mb << 20)){
+    line.clear();
+    size_t target{20 + rng()%101};
+    while(line.size() < target){
+      line += words[rng()%16];
+      line += ' ';
+    }
+    line += rng()%100 == 0 ? "needle\n" : "\n";
+    fh.write_all(line.data(), line.size());
+    bytes += line.size();
+    ++lines;
+  }
+  return lines;
+}
+
+struct Count {
+  size_t lines{0};
+  size_t bytes{0};
+};
+
+void report(const string& label, size_t bytes, size_t lines, double sec){
+  cout << label << ": " << lines/1e6/sec << " M lines/s, " << bytes/1e6/sec << " MB/s\n";
+}
+
+int main(int argc, char* argv[])
+  try{
+    size_t mb{argc>1 ? stoul(argv[1]) : 2048};
+    string fn{argc>2 ? argv[2] : "bench_scan.txt"};
+    int max_threads{argc>3 ? stoi(argv[3])
+	: max(1, static_cast<int>(thread::hardware_concurrency()))};
+    size_t lines{make_file(fn, mb)};
+    size_t file_bytes;
+    {
+      File_handle fh{fn, "rm"};
+      file_bytes = fh.bytes().size();
+    }
+    cout << "file: " << file_bytes/1e6 << " MB, " << lines << " lines (" << fn << "), "
+	 << thread::hardware_concurrency() << " cores\n";
+
+    auto count_line = [](Count& c, string_view line){++c.lines; c.bytes += line.size();};
+    auto add = [](Count& total, Count& part){total.lines += part.lines; total.bytes += part.bytes;};
+    auto grep_line = [](vector<string>& v, string_view line){
+      if(line.find("needle") != string_view::npos)
+	v.emplace_back(line);
+    };
+    auto append = [](vector<string>& total, vector<string>& part){
+      total.insert(total.end(), make_move_iterator(part.begin()), make_move_iterator(part.end()));
+    };
+
+    size_t matches{0};
+    for(string mode : {"rb", "rm"}){
+      {
+	auto t0 = chrono::steady_clock::now();
+	File_handle fh{fn, mode};
+	Count c;
+	for(string_view line : Line_reader{fh, 1<<20})
+	  count_line(c, line);
+	double sec{seconds_since(t0)};
+	if(c.lines != lines)
+	  error("wrong number of lines by Line_reader");
+	report("\"" + mode + "\" Line_reader, count            ", file_bytes, lines, sec);
+      }
+      vector<int> thread_counts;
+      for(int t=1; t<max_threads; t*=2)
+	thread_counts.push_back(t);
+      thread_counts.push_back(max_threads);
+      for(int t : thread_counts){
+	File_handle fh{fn, mode};
+	auto t0 = chrono::steady_clock::now();
+	Count c{scan_lines(fh, Count{}, count_line, add, t)};
+	double sec{seconds_since(t0)};
+	if(c.lines != lines)
+	  error("wrong number of lines by scan_lines()");
+	report("\"" + mode + "\" scan_lines(), count, " + to_string(t) + " thread"
+	       + (t>1 ? "s" : " "), file_bytes, lines, sec);
+
+	t0 = chrono::steady_clock::now();
+	vector<string> found{scan_lines(fh, vector<string>{}, grep_line, append, t)};
+	sec = seconds_since(t0);
+	if(matches == 0)
+	  matches = found.size();
+	else if(found.size() != matches)
+	  error("different matches by scan_lines()");
+	report("\"" + mode + "\" scan_lines(), grep,  " + to_string(t) + " thread"
+	       + (t>1 ? "s" : " "), file_bytes, lines, sec);
+      }
+    }
+    cout << "grep found " << matches << " lines\n";
+
+    remove(fn.c_str());
+    return 0;
+  }
+  catch(exception& e){
+    cerr << e.what() << endl;
+    return 1;
+  }
+  catch(...){
+    cerr << "Unknown error happens\n";
+    return 1;
+  }
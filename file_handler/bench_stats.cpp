@@ -0,0 +1,139 @@
+
+// Benchmark of the cost of the I/O counters of File_handle (file_stats.h). It times the small
+// operations, where the counters cost the most: fgets() and fputs() of short lines, fread()
+// and fwrite() of 16-byte records, and pread() of 4KB, and prints the counters if they are
+// compiled in. Build and run it twice to compare:
+//   make bench_stats && ./bench_stats
+//   make -B bench_stats STATS=-DFILE_HANDLE_STATS && ./bench_stats
+// usage: ./bench_stats [number of lines/records] [file name] [rounds]
+// Each time is the best of the rounds, since a shared machine makes some rounds slower.
+// The file is removed at the end.
+
+#include "std_lib_facilities.h"
+#include "file_handle.h"
+#include<chrono>
+#include<cstdio>		// for remove()
+
+double seconds_since(chrono::steady_clock::time_point t0){
+  return chrono::duration<double>(chrono::steady_clock::now()-t0).count();
+}
+
+struct Record {
+  uint64_t id;
+  double value;
+};
+
+// the best time of rounds runs of f
+template<typename F>
+double best_of(int rounds, F f){
+  double best{1e300};
+  for(int r=0; r<rounds; ++r){
+    auto t0 = chrono::steady_clock::now();
+    f();
+    best = min(best, seconds_since(t0));
+  }
+  return best;
+}
+
+int main(int argc, char* argv[])
+  try{
+    size_t n{argc>1 ? stoul(argv[1]) : 2000000};
+    string fn{argc>2 ? argv[2] : "bench_stats.bin"};
+    int rounds{argc>3 ? stoi(argv[3]) : 5};
+#if defined(FILE_HANDLE_STATS)
+    cout << "counters compiled in (1 of every " << FILE_HANDLE_STATS_SAMPLE << " calls timed)\n";
+#else
+    cout << "counters compiled out\n";
+#endif
+    auto report = [&](const string& label, double sec){
+      cout << label << ": " << sec/n*1e9 << " ns per call\n";
+    };
+    string line(60, 'x');
+    line += '\n';
+
+    report("fputs() of 61 bytes ", best_of(rounds, [&]{
+	  File_handle fh{fn, "w"};
+	  for(size_t i=0; i<n; ++i)
+	    fh.fputs(line);
+	}));
+    string s;
+    size_t lines{0};
+    report("fgets() of 61 bytes ", best_of(rounds, [&]{
+	  File_handle fh{fn, "r"};
+	  lines = 0;
+	  for(fh.fgets(s, 100); s != "EOF"; fh.fgets(s, 100))
+	    ++lines;
+	}));
+    if(lines != n)
+      error("wrong number of lines");
+
+    report("fwrite() of 16 bytes", best_of(rounds, [&]{
+	  File_handle fh{fn, "wb"};
+	  for(size_t i=0; i<n; ++i){
+	    Record r{i, i*0.5};
+	    fh.fwrite(&r, sizeof(r));
+	  }
+	}));
+    uint64_t sum{0};
+    report("fread() of 16 bytes ", best_of(rounds, [&]{
+	  File_handle fh{fn, "rb"};
+	  Record r;
+	  sum = 0;
+	  while(fh.fread(&r, sizeof(r)) == sizeof(r))
+	    sum += r.id;
+	}));
+    if(sum != n*(n - 1)/2)
+      error("wrong records");
+
+    size_t blocks{n*sizeof(Record)/4096};
+    char buf[4096];
+    // the file has blocks blocks of 4KB, and it is read 8 times
+    double sec{best_of(rounds, [&]{
+	for(int k=0; k<8; ++k){
+	  File_handle fh{fn, "rb"};
+	  while(fh.fread(buf, sizeof(buf)) == sizeof(buf))
+	    ;
+	}
+      })};
+    report("fread() of 4KB      ", sec*n/(blocks*8));
+    sec = best_of(rounds, [&]{
+	File_handle fh{fn, "rb"};
+	for(size_t i=0; i<n; ++i)
+	  fh.pread(buf, sizeof(buf), static_cast<off_t>((i*7919 % blocks)*4096));
+      });
+    report("pread() of 4KB      ", sec);
+
+#if defined(FILE_HANDLE_STATS)
+    // the counters of 1 more round of reading records, and of writing and reading lines
+    {
+      File_handle fh{fn, "rb"};
+      Record r;
+      for(size_t i=0; i<n/2; ++i)
+	fh.fread(&r, sizeof(r));
+      for(size_t i=0; i<1000; ++i)
+	fh.pread(buf, sizeof(buf), static_cast<off_t>((i*7919 % blocks)*4096));
+      cout << fh.stats().text() << fh.stats().json() << '\n';
+    }
+    {
+      File_handle fw{fn, "w"};
+      for(size_t i=0; i<n/4; ++i)
+	fw.fputs(line);
+      fw.flush();
+      File_handle fh{fn, "r"};
+      for(fh.fgets(s, 100); s != "EOF"; fh.fgets(s, 100))
+	;
+      cout << fw.stats().text() << fh.stats().text();
+    }
+#endif
+
+    remove(fn.c_str());
+    return 0;
+  }
+  catch(exception& e){
+    cerr << e.what() << endl;
+    return 1;
+  }
+  catch(...){
+    cerr << "Unknown error happens\n";
+    return 1;
+  }
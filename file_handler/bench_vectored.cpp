@@ -0,0 +1,141 @@
+
+// Benchmark of the vectored and positional I/O of File_handle.
+// 1. Small records of a header and 3 buffers, each of which must reach the OS when it is
+//    written (like a log which another process reads): 4 fwrite() and flush() per record,
+//    4 write() system calls per record, and 1 writev() per record, in records/s.
+//    (4 fwrite() without flush() is also shown, which is the fastest, but keeps the records
+//    in the buffer of the process.)
+// 2. Random reads of 4KB by threads sharing 1 File_handle: lseek() + read() under a mutex,
+//    against pread() without any lock, in reads/s.
+// usage: ./bench_vectored [number of records] [number of reads] [file size in MB] [file name]
+// The file is removed at the end.
+
+#include "std_lib_facilities.h"
+#include "file_handle.h"
+#include<chrono>
+#include<thread>
+#include<mutex>
+#include<atomic>
+#include<cstdio>		// for remove()
+
+double seconds_since(chrono::steady_clock::time_point t0){
+  return chrono::duration<double>(chrono::steady_clock::now()-t0).count();
+}
+
+struct Record_head {
+  uint32_t type;
+  uint32_t bytes;
+  uint64_t time;
+};
+
+int main(int argc, char* argv[])
+  try{
+    size_t num_records{argc>1 ? stoul(argv[1]) : 200000};
+    size_t num_reads{argc>2 ? stoul(argv[2]) : 400000};
+    size_t mb{argc>3 ? stoul(argv[3]) : 256};
+    string fn{argc>4 ? argv[4] : "bench_vectored.bin"};
+
+    string key(40, 'k'), value(200, 'v'), tail(24, 't');
+    Record_head head{1, static_cast<uint32_t>(key.size()+value.size()+tail.size()), 0};
+    size_t record_bytes{sizeof(head) + head.bytes};
+    cout << num_records << " records of " << record_bytes << " bytes (a header and 3 buffers)\n";
+    auto report = [&](const string& label, double sec){
+      cout << label << ": " << num_records/sec << " records/s\n";
+    };
+
+    for(int way=0; way<4; ++way){
+      auto t0 = chrono::steady_clock::now();
+      {
+	File_handle fh{fn, "wb"};
+	for(size_t i=0; i<num_records; ++i){
+	  head.time = i;
+	  if(way <= 1){
+	    fh.fwrite(&head, sizeof(head));
+	    fh.fwrite(key.data(), key.size());
+	    fh.fwrite(value.data(), value.size());
+	    fh.fwrite(tail.data(), tail.size());
+	    if(way == 1)
+	      fh.flush();
+	  }
+	  else if(way == 2){
+	    if(::write(fh.fileno(), &head, sizeof(head)) < 0
+	       || ::write(fh.fileno(), key.data(), key.size()) < 0
+	       || ::write(fh.fileno(), value.data(), value.size()) < 0
+	       || ::write(fh.fileno(), tail.data(), tail.size()) < 0)
+	      error("write() failed");
+	  }
+	  else{
+	    iovec iov[]{{&head, sizeof(head)}, {&key[0], key.size()}, {&value[0], value.size()},
+			{&tail[0], tail.size()}};
+	    fh.writev(iov, 4);
+	  }
+	}
+      }
+      const char* labels[]{"4 fwrite(), buffered        ", "4 fwrite() + flush()        ",
+			   "4 write() system calls      ", "1 writev()                  "};
+      report(labels[way], seconds_since(t0));
+    }
+
+    // the file for the reads
+    {
+      File_handle fh{fn, "wb", 1<<20};
+      vector<char> data(1<<20);
+      mt19937 rng{17};
+      for(char& c : data)
+	c = static_cast<char>(rng());
+      for(size_t i=0; i<mb; ++i)
+	fh.write_all(data.data(), data.size());
+    }
+    const size_t block{4096};
+    vector<off_t> offsets(num_reads);
+    mt19937_64 rng{19};
+    for(off_t& o : offsets)
+      o = static_cast<off_t>(rng() % ((mb << 20)/block) * block);
+    cout << num_reads << " random reads of 4KB from " << mb << " MB, by threads sharing 1 "
+	 << "File_handle\n";
+
+    for(int threads : {1, 2, 4, 8}){
+      for(int way=0; way<2; ++way){
+	File_handle fh{fn, "rb"};
+	mutex m;
+	atomic<unsigned long> check{0};
+	auto work = [&](int t){
+	  vector<char> buf(block);
+	  unsigned long sum{0};
+	  for(size_t i=t; i<num_reads; i+=threads){
+	    if(way == 0){
+	      lock_guard<mutex> lk{m};
+	      if(::lseek(fh.fileno(), offsets[i], SEEK_SET) < 0
+		 || ::read(fh.fileno(), buf.data(), block) != static_cast<ssize_t>(block))
+		error("lseek() + read() failed");
+	    }
+	    else if(fh.pread(buf.data(), block, offsets[i]) != block)
+	      error("pread() failed");
+	    sum += static_cast<unsigned char>(buf[0]);
+	  }
+	  check += sum;
+	};
+	auto t0 = chrono::steady_clock::now();
+	vector<thread> ts;
+	for(int t=0; t<threads; ++t)
+	  ts.emplace_back(work, t);
+	for(thread& th : ts)
+	  th.join();
+	double sec{seconds_since(t0)};
+	cout << threads << " thread" << (threads>1 ? "s, " : ",  ")
+	     << (way == 0 ? "lseek()+read() with a mutex" : "pread() without a lock    ")
+	     << ": " << num_reads/sec << " reads/s (checksum " << check << ")\n";
+      }
+    }
+
+    remove(fn.c_str());
+    return 0;
+  }
+  catch(exception& e){
+    cerr << e.what() << endl;
+    return 1;
+  }
+  catch(...){
+    cerr << "Unknown error happens\n";
+    return 1;
+  }
@@ -0,0 +1,272 @@
+
+#ifndef CODEC_GUARD
+#define CODEC_GUARD 1
+
+#include "std_lib_facilities.h"
+#include<cstdint>
+#include<cstring>		// for memcpy()
+#include<memory>		// for unique_ptr
+#if defined(USE_LZ4)
+#include<lz4.h>
+#endif
+#if defined(USE_ZSTD)
+#include<zstd.h>
+#endif
+#if defined(USE_ZLIB)
+#include<zlib.h>
+#endif
+
+// Compressors of blocks of bytes for Compressed_writer/Compressed_reader (compressed_file.h).
+// Lz_codec is built in. The others use the libraries, and are compiled only when they are
+// asked for, since the library must also be linked:
+//   make bench CODECS="-DUSE_LZ4 -llz4 -DUSE_ZSTD -lzstd -DUSE_ZLIB -lz"
+// Each codec has an id, which is written in the file, so that the reader can choose the same
+// codec by make_codec().
+struct Codec {
+  virtual ~Codec(){}
+  virtual uint32_t id() const = 0;
+  virtual string name() const = 0;
+  // the largest size of the compressed bytes of raw_bytes bytes
+  virtual size_t max_compressed_bytes(size_t raw_bytes) const = 0;
+  // compress the n bytes of src into dst of cap bytes, and return the compressed size (0 if
+  // it doesn't fit)
+  virtual size_t compress(const char* src, size_t n, char* dst, size_t cap) const = 0;
+  // decompress the n bytes of src into exactly raw bytes of dst. throws if src is broken
+  virtual void decompress(const char* src, size_t n, char* dst, size_t raw) const = 0;
+};
+
+// A simple LZ77 compressor, which writes the block format of LZ4 (so liblz4 can decompress
+// its output too): a sequence of
+//   token (1 byte): the number of literals (4 bits) and the length of the match - 4 (4 bits)
+//   (if 15, more bytes of the number follow, each 255 means "more")
+//   the literals
+//   offset (2 bytes, little-endian): how far back the match starts
+//   (more bytes of the length of the match)
+// The last sequence has only literals. Repeats are found by a hash table of the positions of
+// 4-byte sequences, and the table only remembers the last position of each hash, so it
+// compresses less than LZ4 (which is also more careful), but it is fast and has no dependency.
+class Lz_codec : public Codec {
+public:
+  uint32_t id() const override {return 1;}
+  string name() const override {return "lz (built-in)";}
+  size_t max_compressed_bytes(size_t n) const override {return n + n/255 + 16;}
+  size_t compress(const char* src, size_t n, char* dst, size_t cap) const override;
+  void decompress(const char* src, size_t n, char* dst, size_t raw) const override;
+
+private:
+  static constexpr int hash_log{14};
+  static constexpr size_t min_match{4};
+  static constexpr size_t last_literals{5};	// the format ends with 5 literals or more
+  static constexpr size_t match_limit{12};	// no match starts in the last 12 bytes
+
+  static uint32_t read32(const char* p){uint32_t v; memcpy(&v, p, 4); return v;}
+  static uint32_t hash(uint32_t v){return (v * 2654435761u) >> (32 - hash_log);}
+  // write the length n - 15 in bytes of 255 (after a token of 15)
+  static char* put_length(char* op, size_t n){
+    for(; n >= 255; n -= 255)
+      *op++ = static_cast<char>(255);
+    *op++ = static_cast<char>(n);
+    return op;
+  }
+};
+
+inline size_t Lz_codec::compress(const char* src, size_t n, char* dst, size_t cap) const {
+  if(cap < max_compressed_bytes(n))
+    return 0;			// then every write below fits
+  vector<uint32_t> table(size_t{1} << hash_log, 0);  // position + 1, 0 for none
+  size_t ip{0}, anchor{0};
+  char* op{dst};
+  size_t misses{0};
+  while(n >= match_limit && ip < n - match_limit){
+    uint32_t seq{read32(src + ip)};
+    uint32_t& slot{table[hash(seq)]};
+    size_t ref{slot};
+    slot = static_cast<uint32_t>(ip + 1);
+    if(ref == 0 || ip - (ref - 1) > 65535 || read32(src + ref - 1) != seq){
+      // skip faster through bytes that don't compress
+      ip += 1 + (misses++ >> 6);
+      continue;
+    }
+    misses = 0;
+    --ref;
+    size_t len{min_match};
+    size_t max_len{n - last_literals - ip};
+    // compare 8 bytes at a time, and then the last different 8 bytes byte by byte
+    while(len + 8 <= max_len){
+      uint64_t a, b;
+      memcpy(&a, src + ref + len, 8);
+      memcpy(&b, src + ip + len, 8);
+      if(a != b)
+	break;
+      len += 8;
+    }
+    while(len < max_len && src[ref + len] == src[ip + len])
+      ++len;
+    size_t lits{ip - anchor};
+    char* token{op++};
+    *token = static_cast<char>((min(lits, size_t{15}) << 4) | min(len - min_match, size_t{15}));
+    if(lits >= 15)
+      op = put_length(op, lits - 15);
+    memcpy(op, src + anchor, lits);
+    op += lits;
+    uint16_t offset{static_cast<uint16_t>(ip - ref)};
+    *op++ = static_cast<char>(offset & 0xff);
+    *op++ = static_cast<char>(offset >> 8);
+    if(len - min_match >= 15)
+      op = put_length(op, len - min_match - 15);
+    ip += len;
+    anchor = ip;
+  }
+  size_t lits{n - anchor};
+  *op++ = static_cast<char>(min(lits, size_t{15}) << 4);
+  if(lits >= 15)
+    op = put_length(op, lits - 15);
+  memcpy(op, src + anchor, lits);
+  op += lits;
+  return op - dst;
+}
+
+inline void Lz_codec::decompress(const char* src, size_t n, char* dst, size_t raw) const {
+  const unsigned char* ip{reinterpret_cast<const unsigned char*>(src)};
+  const unsigned char* iend{ip + n};
+  size_t o{0};
+  auto broken = [](){error("Error in Lz_codec::decompress(). The compressed data is broken.");};
+  // read the rest of a length after a 4-bit 15
+  auto length = [&](size_t l){
+    if(l == 15){
+      unsigned char b;
+      do{
+	if(ip == iend)
+	  broken();
+	b = *ip++;
+	l += b;
+      }while(b == 255);
+    }
+    return l;
+  };
+  while(ip < iend){
+    unsigned char token{*ip++};
+    size_t lits{length(token >> 4)};
+    if(lits > static_cast<size_t>(iend - ip) || lits > raw - o)
+      broken();
+    // most runs of literals are short, and copying a fixed 16 bytes is 2 instructions,
+    // while memcpy() of a variable size is a call
+    if(lits <= 16 && static_cast<size_t>(iend - ip) >= 16 && raw - o >= 16)
+      memcpy(dst + o, ip, 16);
+    else
+      memcpy(dst + o, ip, lits);
+    ip += lits;
+    o += lits;
+    if(ip == iend)
+      break;			// the last sequence has no match
+    if(iend - ip < 2)
+      broken();
+    size_t offset{static_cast<size_t>(ip[0] | ip[1] << 8)};
+    ip += 2;
+    size_t len{length(token & 15) + min_match};
+    if(offset == 0 || offset > o || len > raw - o)
+      broken();
+    char* d{dst + o};
+    const char* s{d - offset};
+    if(offset >= 16 && o + len + 16 <= raw)
+      // copy 16 bytes at a time (each 16 bytes are already there, since offset >= 16), and
+      // maybe a few bytes too many, which the next sequence overwrites
+      for(size_t i=0; i<len; i+=16)
+	memcpy(d + i, s + i, 16);
+    else if(offset >= 8 && o + len + 8 <= raw)
+      for(size_t i=0; i<len; i+=8)
+	memcpy(d + i, s + i, 8);
+    else
+      for(size_t i=0; i<len; ++i)	// the match may overlap what it writes (a repeat)
+	d[i] = s[i];
+    o += len;
+  }
+  if(o != raw)
+    broken();
+}
+
+#if defined(USE_LZ4)
+class Lz4_codec : public Codec {
+public:
+  uint32_t id() const override {return 2;}
+  string name() const override {return "lz4";}
+  size_t max_compressed_bytes(size_t n) const override {return LZ4_compressBound(static_cast<int>(n));}
+  size_t compress(const char* src, size_t n, char* dst, size_t cap) const override {
+    int r{LZ4_compress_default(src, dst, static_cast<int>(n), static_cast<int>(cap))};
+    return r > 0 ? r : 0;
+  }
+  void decompress(const char* src, size_t n, char* dst, size_t raw) const override {
+    if(LZ4_decompress_safe(src, dst, static_cast<int>(n), static_cast<int>(raw))
+       != static_cast<int>(raw))
+      error("Error in Lz4_codec::decompress(). The compressed data is broken.");
+  }
+};
+#endif
+
+#if defined(USE_ZSTD)
+class Zstd_codec : public Codec {
+public:
+  explicit Zstd_codec(int lv = 3) : level{lv} {}
+  uint32_t id() const override {return 3;}
+  string name() const override {return "zstd -" + to_string(level);}
+  size_t max_compressed_bytes(size_t n) const override {return ZSTD_compressBound(n);}
+  size_t compress(const char* src, size_t n, char* dst, size_t cap) const override {
+    size_t r{ZSTD_compress(dst, cap, src, n, level)};
+    return ZSTD_isError(r) ? 0 : r;
+  }
+  void decompress(const char* src, size_t n, char* dst, size_t raw) const override {
+    size_t r{ZSTD_decompress(dst, raw, src, n)};
+    if(ZSTD_isError(r) || r != raw)
+      error("Error in Zstd_codec::decompress(). The compressed data is broken.");
+  }
+private:
+  int level;
+};
+#endif
+
+#if defined(USE_ZLIB)
+class Zlib_codec : public Codec {
+public:
+  explicit Zlib_codec(int lv = 6) : level{lv} {}
+  uint32_t id() const override {return 4;}
+  string name() const override {return "zlib -" + to_string(level);}
+  size_t max_compressed_bytes(size_t n) const override {return compressBound(n);}
+  size_t compress(const char* src, size_t n, char* dst, size_t cap) const override {
+    uLongf d{cap};
+    if(compress2(reinterpret_cast<Bytef*>(dst), &d, reinterpret_cast<const Bytef*>(src), n,
+		 level) != Z_OK)
+      return 0;
+    return d;
+  }
+  void decompress(const char* src, size_t n, char* dst, size_t raw) const override {
+    uLongf d{raw};
+    if(uncompress(reinterpret_cast<Bytef*>(dst), &d, reinterpret_cast<const Bytef*>(src), n)
+       != Z_OK || d != raw)
+      error("Error in Zlib_codec::decompress(). The compressed data is broken.");
+  }
+private:
+  int level;
+};
+#endif
+
+// the codec of the id written in a file, with its default level
+inline unique_ptr<Codec> make_codec(uint32_t id){
+  switch(id){
+  case 1: return unique_ptr<Codec>{new Lz_codec};
+#if defined(USE_LZ4)
+  case 2: return unique_ptr<Codec>{new Lz4_codec};
+#endif
+#if defined(USE_ZSTD)
+  case 3: return unique_ptr<Codec>{new Zstd_codec};
+#endif
+#if defined(USE_ZLIB)
+  case 4: return unique_ptr<Codec>{new Zlib_codec};
+#endif
+  default:
+    error("Error in make_codec(). The codec " + to_string(id) + " is unknown or not compiled "
+	  "in (see CODECS in the makefile).");
+  }
+  return nullptr;
+}
+
+#endif // CODEC_GUARD
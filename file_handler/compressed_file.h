@@ -0,0 +1,325 @@
+
+#ifndef COMPRESSED_FILE_GUARD
+#define COMPRESSED_FILE_GUARD 1
+
+#include "std_lib_facilities.h"
+#include "file_handle.h"
+#include "codec.h"
+#include "crc32c.h"
+#include<cstdint>
+#include<cstring>		// for memcmp()
+#include<thread>
+#include<algorithm>		// for upper_bound()
+#include<exception>		// for exception_ptr
+#include<unistd.h>		// for pread() (POSIX)
+#include<sys/stat.h>		// for fstat() (POSIX)
+
+// A file compressed in independent blocks ("frames"), written through a File_handle.
+// The bytes written are cut into blocks of block_bytes, and each block is compressed by
+// itself, so a reader can start at any block without decompressing the ones before it, and
+// decompress many blocks at the same time on different threads.
+// The file is:
+//   File_header (16 bytes)
+//   blocks: Block_header (16 bytes) and the stored bytes, for each block
+//   the index: 1 Block_entry per block (where it starts in the file, and in the raw bytes)
+//   Footer (24 bytes), which tells where the index is
+// A block that doesn't get smaller is stored as it is. Each block has the CRC-32C of its raw
+// bytes, so a damaged block is detected after decompression.
+// The numbers are in the byte order of the machine (the magic numbers catch the other one).
+
+namespace compressed_file_detail {
+  struct File_header {
+    char magic[4];		// "CMPF"
+    uint16_t version;
+    uint16_t reserved;
+    uint32_t codec_id;
+    uint32_t block_bytes;
+  };
+  struct Block_header {
+    uint32_t raw_bytes;
+    uint32_t stored_bytes;
+    uint32_t crc;		// CRC-32C of the raw bytes
+    uint32_t flags;
+    static constexpr uint32_t stored_raw{1};	// the block is not compressed
+  };
+  struct Block_entry {
+    uint64_t offset;		// of the Block_header in the file
+    uint64_t raw_offset;	// of the first raw byte of the block
+  };
+  struct Footer {
+    uint64_t index_offset;
+    uint64_t blocks;
+    char magic[4];		// "CMPX"
+    uint32_t index_crc;		// CRC-32C of the index
+  };
+  static_assert(sizeof(File_header) == 16 && sizeof(Block_header) == 16
+		&& sizeof(Block_entry) == 16 && sizeof(Footer) == 24, "no padding");
+  constexpr uint16_t current_version{1};
+
+  // read exactly n bytes at offset of fd (pread() doesn't move the position of the file, so
+  // threads can read the same file at the same time)
+  inline void pread_all(int fd, void* buf, size_t n, uint64_t offset){
+    char* p{static_cast<char*>(buf)};
+    while(n > 0){
+      ssize_t r{pread(fd, p, n, static_cast<off_t>(offset))};
+      if(r <= 0)
+	error("Error in reading a compressed file. The file is too short or cannot be read.");
+      p += r;
+      n -= r;
+      offset += r;
+    }
+  }
+}
+
+class Compressed_writer {
+public:
+  // the codec must live until finish()
+  Compressed_writer(const string& fn, const Codec& c, size_t block_bytes = 1<<20);
+  ~Compressed_writer();		// finish()es, if not yet
+  Compressed_writer(const Compressed_writer&) = delete;
+  Compressed_writer& operator=(const Compressed_writer&) = delete;
+
+  void write(const void* p, size_t n);
+  // write the last block, the index and the footer. Nothing can be written after it
+  void finish();
+
+  uint64_t raw_bytes() const {return raw_total;}
+  uint64_t file_bytes() const {return offset;}	// so far
+
+private:
+  File_handle fh;
+  const Codec& codec;
+  vector<char> block;		// the raw bytes of the current block
+  size_t used{0};
+  vector<char> out;		// the compressed block
+  vector<compressed_file_detail::Block_entry> index;
+  uint64_t offset{0};		// the bytes written to the file
+  uint64_t raw_total{0};
+  uint64_t raw_flushed{0};	// the raw bytes of the blocks written
+  bool finished{false};
+
+  void write_block();
+  void put(const void* p, size_t n){fh.write_all(p, n); offset += n;}
+};
+
+inline Compressed_writer::Compressed_writer(const string& fn, const Codec& c, size_t block_bytes)
+  : fh{fn, "wb", 1<<16}, codec{c}, block(block_bytes),
+    out(c.max_compressed_bytes(block_bytes))
+{
+  using namespace compressed_file_detail;
+  if(block_bytes == 0 || block_bytes > UINT32_MAX)
+    error("Error in Compressed_writer. The block size must be 1 byte to 4GB.");
+  File_header h{{'C','M','P','F'}, current_version, 0, codec.id(),
+      static_cast<uint32_t>(block_bytes)};
+  put(&h, sizeof(h));
+}
+
+inline Compressed_writer::~Compressed_writer(){
+  try{
+    finish();
+  }
+  catch(...){}			// a destructor must not throw. Call finish() to see the error
+}
+
+inline void Compressed_writer::write(const void* p, size_t n){
+  if(finished)
+    error("Error in Compressed_writer::write(). Already finished.");
+  const char* c{static_cast<const char*>(p)};
+  raw_total += n;
+  while(n > 0){
+    size_t k{min(n, block.size() - used)};
+    memcpy(block.data() + used, c, k);
+    used += k;
+    c += k;
+    n -= k;
+    if(used == block.size())
+      write_block();
+  }
+}
+
+inline void Compressed_writer::write_block(){
+  using namespace compressed_file_detail;
+  if(used == 0)
+    return;
+  index.push_back(Block_entry{offset, raw_flushed});
+  raw_flushed += used;
+  size_t c{codec.compress(block.data(), used, out.data(), out.size())};
+  Block_header h{static_cast<uint32_t>(used), 0, crc32c(block.data(), used), 0};
+  if(c == 0 || c >= used){
+    h.stored_bytes = h.raw_bytes;
+    h.flags = Block_header::stored_raw;
+    put(&h, sizeof(h));
+    put(block.data(), used);
+  }
+  else{
+    h.stored_bytes = static_cast<uint32_t>(c);
+    put(&h, sizeof(h));
+    put(out.data(), c);
+  }
+  used = 0;
+}
+
+inline void Compressed_writer::finish(){
+  using namespace compressed_file_detail;
+  if(finished)
+    return;
+  finished = true;
+  write_block();
+  Footer f{offset, index.size(), {'C','M','P','X'},
+      crc32c(index.data(), index.size()*sizeof(Block_entry))};
+  put(index.data(), index.size()*sizeof(Block_entry));
+  put(&f, sizeof(f));
+  fh.flush();
+}
+
+class Compressed_reader {
+public:
+  explicit Compressed_reader(const string& fn);
+
+  size_t blocks() const {return index.size();}
+  uint64_t raw_bytes() const {return raw_total;}
+  string codec_name() const {return codec->name();}
+  // the first raw byte of block i, and the block that has the raw byte at raw_offset (to seek)
+  uint64_t block_raw_offset(size_t i) const {return index[i].raw_offset;}
+  size_t find_block(uint64_t raw_offset) const;
+
+  // decompress block i into out (resized to the raw bytes of the block). Threads can call
+  // this for different blocks at the same time
+  void read_block(size_t i, vector<char>& out) const;
+  // all the raw bytes, decompressed by num_threads threads
+  vector<char> read_all(int num_threads = 1) const;
+
+private:
+  File_handle fh;
+  unique_ptr<Codec> codec;
+  vector<compressed_file_detail::Block_entry> index;
+  uint64_t index_offset;	// the end of the last block
+  uint64_t raw_total{0};
+
+  // block i into dst, which has room for exactly its raw bytes. buf is for the stored bytes
+  size_t read_block_into(size_t i, char* dst, size_t room, vector<char>& buf) const;
+};
+
+inline Compressed_reader::Compressed_reader(const string& fn)
+  : fh{fn, "rb"}
+{
+  using namespace compressed_file_detail;
+  struct stat st;
+  if(fstat(fh.fileno(), &st) != 0)
+    error("Error in Compressed_reader. Cannot get the file size.");
+  uint64_t size{static_cast<uint64_t>(st.st_size)};
+  if(size < sizeof(File_header) + sizeof(Footer))
+    error("Error in Compressed_reader. The file is too short.");
+  File_header h;
+  pread_all(fh.fileno(), &h, sizeof(h), 0);
+  if(memcmp(h.magic, "CMPF", 4) != 0 || h.version != current_version || h.block_bytes == 0)
+    error("Error in Compressed_reader. It is not a compressed file of this version.");
+  codec = make_codec(h.codec_id);
+  Footer f;
+  pread_all(fh.fileno(), &f, sizeof(f), size - sizeof(f));
+  // blocks*sizeof(Block_entry) can wrap around with a corrupt footer, so blocks is checked
+  // by a division first
+  uint64_t room{size - sizeof(File_header) - sizeof(Footer)};
+  if(memcmp(f.magic, "CMPX", 4) != 0 || f.blocks > room/sizeof(Block_entry)
+     || f.index_offset != size - sizeof(Footer) - f.blocks*sizeof(Block_entry))
+    error("Error in Compressed_reader. The footer is broken (the file may be truncated).");
+  index.resize(f.blocks);
+  pread_all(fh.fileno(), index.data(), index.size()*sizeof(Block_entry), f.index_offset);
+  if(crc32c(index.data(), index.size()*sizeof(Block_entry)) != f.index_crc)
+    error("Error in Compressed_reader. The index is damaged.");
+  index_offset = f.index_offset;
+
+  // The CRC only catches accidental damage, since anyone can recompute it. The reads put
+  // block i at out.data() + raw_offset, so the index must be what the writer makes: the
+  // blocks follow each other from the end of File_header to the index, and every block but
+  // the last has block_bytes raw bytes
+  for(size_t i=0; i<index.size(); ++i){
+    const Block_entry& e{index[i]};
+    bool ok{(i == 0)? e.offset == sizeof(File_header) && e.raw_offset == 0
+	    : e.offset >= index[i-1].offset + sizeof(Block_header)
+	      && e.raw_offset > index[i-1].raw_offset
+	      && e.raw_offset - index[i-1].raw_offset == h.block_bytes};
+    if(!ok || e.offset > index_offset || index_offset - e.offset < sizeof(Block_header))
+      error("Error in Compressed_reader. The index entry of the block " + to_string(i)
+	    + " is broken.");
+  }
+  if(index.empty() && index_offset != sizeof(File_header))
+    error("Error in Compressed_reader. The index is broken.");
+  if(!index.empty()){
+    Block_header last;
+    pread_all(fh.fileno(), &last, sizeof(last), index.back().offset);
+    if(last.raw_bytes == 0 || last.raw_bytes > h.block_bytes
+       || last.raw_bytes > UINT64_MAX - index.back().raw_offset)
+      error("Error in Compressed_reader. The block " + to_string(index.size() - 1)
+	    + " is broken.");
+    raw_total = index.back().raw_offset + last.raw_bytes;
+  }
+}
+
+inline size_t Compressed_reader::find_block(uint64_t raw_offset) const {
+  if(raw_offset >= raw_total)
+    error("Error in Compressed_reader::find_block(). Out of range.");
+  // the last block that starts at or before raw_offset
+  auto p = upper_bound(index.begin(), index.end(), raw_offset,
+		       [](uint64_t r, const compressed_file_detail::Block_entry& e)
+		       {return r < e.raw_offset;});
+  return static_cast<size_t>(p - index.begin()) - 1;
+}
+
+inline size_t Compressed_reader::read_block_into(size_t i, char* dst, size_t room,
+						 vector<char>& buf) const {
+  using namespace compressed_file_detail;
+  Block_header h;
+  pread_all(fh.fileno(), &h, sizeof(h), index[i].offset);
+  uint64_t end{i+1 < index.size() ? index[i+1].offset : index_offset};
+  if(h.raw_bytes != room || index[i].offset + sizeof(h) + h.stored_bytes != end)
+    error("Error in Compressed_reader. The block " + to_string(i) + " is broken.");
+  if(h.flags & Block_header::stored_raw)
+    pread_all(fh.fileno(), dst, h.raw_bytes, index[i].offset + sizeof(h));
+  else{
+    buf.resize(h.stored_bytes);
+    pread_all(fh.fileno(), buf.data(), h.stored_bytes, index[i].offset + sizeof(h));
+    codec->decompress(buf.data(), h.stored_bytes, dst, h.raw_bytes);
+  }
+  if(crc32c(dst, h.raw_bytes) != h.crc)
+    error("Error in Compressed_reader. The checksum of the block " + to_string(i)
+	  + " doesn't match (the file is damaged).");
+  return h.raw_bytes;
+}
+
+inline void Compressed_reader::read_block(size_t i, vector<char>& out) const {
+  uint64_t end{i+1 < index.size() ? index[i+1].raw_offset : raw_total};
+  out.resize(end - index[i].raw_offset);
+  vector<char> buf;
+  read_block_into(i, out.data(), out.size(), buf);
+}
+
+inline vector<char> Compressed_reader::read_all(int num_threads) const {
+  vector<char> out(raw_total);
+  num_threads = max(1, min(num_threads, static_cast<int>(index.size())));
+  vector<exception_ptr> errors(num_threads);
+  auto work = [&](int t){
+    try{
+      vector<char> buf;
+      for(size_t i=t; i<index.size(); i+=num_threads){
+	uint64_t end{i+1 < index.size() ? index[i+1].raw_offset : raw_total};
+	read_block_into(i, out.data() + index[i].raw_offset, end - index[i].raw_offset, buf);
+      }
+    }
+    catch(...){
+      errors[t] = current_exception();
+    }
+  };
+  vector<thread> threads;
+  for(int t=1; t<num_threads; ++t)
+    threads.emplace_back(work, t);
+  work(0);
+  for(thread& th : threads)
+    th.join();
+  for(exception_ptr& e : errors)
+    if(e)
+      rethrow_exception(e);
+  return out;
+}
+
+#endif // COMPRESSED_FILE_GUARD
@@ -0,0 +1,435 @@
+
+#ifndef FILE_HANDLE_GUARD
+#define FILE_HANDLE_GUARD 1
+
+#include "std_lib_facilities.h"
+#include<cstring>		// for memcpy(), memchr()
+#include<algorithm>		// for remove(), min()
+#include<sys/mman.h>		// for mmap(), madvise() (POSIX)
+#include<sys/stat.h>		// for fstat() (POSIX)
+#include<sys/uio.h>		// for iovec, writev(), preadv(), pwritev() (POSIX)
+#include<unistd.h>		// for pread(), pwrite() (POSIX)
+#include<climits>		// for IOV_MAX
+#include<cerrno>
+#include<memory>		// for unique_ptr
+#include "file_stats.h"
+
+// a read-only view of bytes, like std::span<const unsigned char> of C++20
+struct Byte_span {
+  const unsigned char* ptr;
+  size_t n;
+
+  const unsigned char* data() const {return ptr;}
+  size_t size() const {return n;}
+  bool empty() const {return n == 0;}
+  const unsigned char* begin() const {return ptr;}
+  const unsigned char* end() const {return ptr + n;}
+  unsigned char operator[](size_t i) const {return ptr[i];}
+};
+
+// Since fstream already practices RAII, I use C-style file management (FILE*, fopen(), fclose())
+struct File_handle {
+  // how the mapped bytes are going to be read, for madvise()
+  enum class Advice {normal, sequential, random, willneed};
+
+  // buffer_bytes: the size of the buffer of the FILE*. 0 keeps the default of stdio (4 KB or
+  // the block size of the file system). A larger buffer means fewer read()/write() system
+  // calls for small operations. The buffer is owned by this object
+  // file_mode can have 'm' (like "rm", from the same extension of fopen() of glibc) to map
+  // the whole file into memory by mmap() instead of reading it through the buffer of the
+  // FILE*. Then fgetc(), fgets() and fread() copy from the mapping, and bytes() gives the
+  // mapped bytes themselves, without any copy. Only reading is allowed in this mode. If the
+  // file cannot be mapped (a pipe, a terminal, or an empty file), the file is read through
+  // the buffer as usual, and mapped() tells which one happened.
+  File_handle(const string& fn, const string& file_mode, size_t buffer_bytes = 0)
+    : file_ptr{fopen(fn.c_str(), without_m(file_mode).c_str())}
+  {
+    if(file_ptr == nullptr){	// check if the file is properly opened
+      throw runtime_error("Error. File cannot be opened properly.");
+    }
+    if(file_mode.find('m') != string::npos){
+      if(file_mode.find_first_of("wa+") != string::npos){
+	fclose(file_ptr);
+	throw runtime_error("Error in File_handle. The mode 'm' is only for reading.");
+      }
+      map_file();
+    }
+    if(buffer_bytes > 0 && !mapped()){
+      // setvbuf() must be called before any I/O on the file
+      buffer.resize(buffer_bytes);
+      if(setvbuf(file_ptr, buffer.data(), _IOFBF, buffer_bytes) != 0){
+	fclose(file_ptr);	// the destructor is not called when the constructor throws
+	throw runtime_error("Error in File_handle. Cannot set the buffer size.");
+      }
+    }
+  }
+  ~File_handle(){
+    if(mapped())
+      munmap(map_ptr, map_bytes);
+    fclose(file_ptr);
+  }
+  // Copying would close the same FILE* twice
+  File_handle(const File_handle&) = delete;
+  File_handle& operator=(const File_handle&) = delete;
+
+  // the member functions are from the usual ways of using a file pointer.
+  // Inspired from chapter 14 of another book "Practical C Programming"
+  // read 1 character from ASCII (text) file
+  // getc_unlocked() (POSIX) is fgetc() without locking the FILE* for each character. The
+  // lock is only for sharing 1 FILE* among threads, which a File_handle doesn't do, and
+  // for reading a file character by character, taking the lock costs more than the read.
+  char fgetc(){
+    File_op_scope st{stats_ptr(), File_op::fgetc};
+    if(mapped()){
+      bool more{pos < map_bytes};
+      char c = more ? map_ptr[pos++] : EOF;
+      st.done(more, 0);
+      return c;
+    }
+    int c{getc_unlocked(file_ptr)};
+    st.done(c != EOF, 0);
+    return c;
+  }
+  // Aside: the :: qualifier without preceding namespace tells the compiler to look for the
+  //        global namespace first. Without this ::, since this class also has the function
+  //        named fgetc(), and compiler look from close namespace, it matches
+  //        File_handle::fgetc() before matching global (original) fgetc(). To match the
+  //        original one first, I put :: before fgetc().
+  // https://stackoverflow.com/questions/4269034/
+  void fputc(char ch){			// write 1 character to ASCII file
+    File_op_scope st{stats_ptr(), File_op::fputc};
+    putc_unlocked(ch, file_ptr);
+    st.done(1, 0);
+  }
+
+  // read size characters or until it hits '\n'. If ::fgets() hits the end of file, cstr stores
+  // null
+  // (s becomes "EOF" at the end of the file, which cannot be told from a line "EOF" without
+  // '\n' at the end of the file. Line_reader of line_reader.h doesn't have this problem.)
+  void fgets(string& s, int size=1){	      
+    File_op_scope st{stats_ptr(), File_op::fgets};
+    if(mapped()){
+      if(pos == map_bytes){
+	s = "EOF";
+	st.done(0, 0);
+	return;
+      }
+      // up to size characters, and the '\n' is included like ::fgets()
+      size_t n{min(static_cast<size_t>(size), map_bytes - pos)};
+      const void* nl{memchr(map_ptr + pos, '\n', n)};
+      if(nl != nullptr)
+	n = static_cast<const char*>(nl) - (map_ptr + pos) + 1;
+      s.assign(map_ptr + pos, n);
+      pos += n;
+      st.done(n, 0);
+      return;
+    }
+    char cstr[size+1];
+    if(::fgets(cstr, size+1, file_ptr) == nullptr){
+    // Those +1 is for the null character '\0' or 0. ::fgets(cstr, size, file_ptr) reads size-1
+    // characters, and fill the last character with '\0'. So, to read size characters, we need
+    // to put size+1 in fgets(). Then, it reads size characters, and add '\0' to the last, and
+    // store it to cstr. Thus, cstr also needs size+1 characters.
+
+      // ::fgets() returns nullptr if it hits the end of file
+      s = "EOF";
+      st.done(0, 0);
+      return;
+    }
+    s = cstr;		// it seems there is the appropriate assignment operator from
+    // char* to string
+    st.done(s.size(), 0);
+  }
+
+  // write the string to file
+  void fputs(const string& s){
+    File_op_scope st{stats_ptr(), File_op::fputs};
+    if(::fputs(s.c_str(), file_ptr)){}
+    // ::fputs() returns EOF (== -1 here) if error occured. Otherwise, it returns a non-negative
+    // number.
+    else
+      throw runtime_error("Error in File_handle::fputs().");
+    st.done(s.size(), 0);
+  }
+
+  // read binary file
+  // Read up to read_bytes bytes from the current reading position directly into var_ptr, and
+  // return the number of bytes actually read, which is less than read_bytes only at the end
+  // of the file.
+  // I used to read into a char array on the stack first and then copy it to var_ptr byte by
+  // byte, to check read error before touching var_ptr. But the array is as large as the
+  // request, so reading a few MB overflowed the stack, and the copy doubled the work. If
+  // ::fread() fails, the bytes in var_ptr are just not meaningful, and the exception tells
+  // the caller so. (::fread() itself copies from the buffer of the FILE*, or reads large
+  // requests straight from the file into var_ptr without the buffer.)
+  size_t fread(void *var_ptr, size_t read_bytes){
+    File_op_scope st{stats_ptr(), File_op::fread};
+    if(mapped()){
+      size_t n{min(read_bytes, map_bytes - pos)};
+      memcpy(var_ptr, map_ptr + pos, n);
+      pos += n;
+      st.done(n, 0);
+      return n;
+    }
+    size_t read_size{::fread(var_ptr, 1, read_bytes, file_ptr)};
+    // check file error
+    if(ferror(file_ptr))
+      throw runtime_error("Error in File_handle::fread(). Reading failed.");
+    st.done(read_size, 0);
+    return read_size;
+  }
+
+  // write to binary file
+  void fwrite(const void *var_ptr, size_t write_bytes){
+    File_op_scope st{stats_ptr(), File_op::fwrite};
+    ::fwrite(var_ptr, 1, write_bytes, file_ptr);
+    if(ferror(file_ptr))
+      throw runtime_error("Error in File_handle::fwrite(). Writing failed.");
+    st.done(write_bytes, 0);
+  }
+
+  // Read exactly read_bytes bytes, or throw. fread() returns a short count at the end of
+  // the file, which is easy to ignore (and then the rest of var_ptr is garbage). A record of
+  // a binary file is either read completely or it is an error
+  void read_exact(void *var_ptr, size_t read_bytes){
+    char *p{static_cast<char*>(var_ptr)};
+    size_t done{0};
+    while(done < read_bytes){
+      size_t n{fread(p + done, read_bytes - done)};
+      if(n == 0)
+	throw runtime_error("Error in File_handle::read_exact(). The file ended before all the bytes were read.");
+      done += n;
+    }
+  }
+
+  // write all write_bytes bytes, or throw. ::fwrite() may write less than requested (e.g. the
+  // disk is full), so the rest is retried until nothing more can be written
+  void write_all(const void *var_ptr, size_t write_bytes){
+    const char *p{static_cast<const char*>(var_ptr)};
+    size_t done{0};
+    while(done < write_bytes){
+      File_op_scope st{stats_ptr(), File_op::fwrite};
+      size_t n{::fwrite(p + done, 1, write_bytes - done, file_ptr)};
+      if(n == 0 || ferror(file_ptr))
+	throw runtime_error("Error in File_handle::write_all(). Writing failed.");
+      st.done(n, 0);
+      done += n;
+    }
+  }
+
+  // write the buffered bytes to the file
+  void flush(){
+    File_op_scope st{stats_ptr(), File_op::flush};
+    bool pending{File_op_scope::write_pending(file_ptr)};
+    if(fflush(file_ptr) != 0)
+      throw runtime_error("Error in File_handle::flush().");
+    st.done(0, pending);
+  }
+
+  // the file descriptor, for the POSIX functions that take it (e.g. mmap())
+  int fileno() const {return ::fileno(file_ptr);}
+
+  // Positional reads and writes: at offset bytes from the start of the file, without using or
+  // moving the reading/writing position of fgets(), fread(), fwrite() etc. Since they don't
+  // touch the FILE*, many threads can call them on the same File_handle at the same time
+  // (for example, readers of random records of 1 big file), where fseek() + fread() would
+  // need a lock around the pair.
+  // They bypass the buffer of the FILE*, so flush() the bytes of fwrite() first if they have
+  // to be seen by pread(), or if pwrite() should overwrite them.
+  // pread() returns the bytes read, which is less than read_bytes only at the end of the
+  // file. (A mapped file is copied from the mapping.)
+  size_t pread(void *var_ptr, size_t read_bytes, off_t offset) const {
+    File_op_scope st{stats_ptr(), File_op::pread, true};
+    uint64_t calls{0};
+    size_t n{pread_all(var_ptr, read_bytes, offset, calls)};
+    st.done(n, calls);
+    return n;
+  }
+
+  void pwrite(const void *var_ptr, size_t write_bytes, off_t offset){
+    File_op_scope st{stats_ptr(), File_op::pwrite, true};
+    const char *p{static_cast<const char*>(var_ptr)};
+    size_t done{0};
+    uint64_t calls{0};
+    while(done < write_bytes){
+      ssize_t n{::pwrite(fileno(), p + done, write_bytes - done, offset + done)};
+      ++calls;
+      if(n < 0 && errno == EINTR)
+	continue;
+      if(n <= 0)
+	throw runtime_error("Error in File_handle::pwrite(). Writing failed.");
+      done += n;
+    }
+    st.done(write_bytes, calls);
+  }
+
+  // Scatter/gather: many buffers (e.g. a header and the records after it) read or written
+  // by 1 system call, without copying them into 1 buffer first. iov[i] is {pointer, bytes}.
+  // writev() writes at the current writing position, after the bytes of fwrite() (it flushes
+  // them first). preadv()/pwritev() are positional, like pread()/pwrite().
+  // The system calls take at most IOV_MAX (1024 on Linux) buffers, and may write less than
+  // all, so the rest is written by more calls.
+  void writev(const iovec *iov, int iovcnt){
+    flush();
+    File_op_scope st{stats_ptr(), File_op::writev};
+    uint64_t calls{0};
+    size_t n{transfer_v(iov, iovcnt, -1, false, calls)};
+    st.done(n, calls);
+  }
+  size_t preadv(const iovec *iov, int iovcnt, off_t offset) const {
+    File_op_scope st{stats_ptr(), File_op::preadv, true};
+    uint64_t calls{0};
+    size_t n{transfer_v(iov, iovcnt, offset, true, calls)};
+    st.done(n, calls);
+    return n;
+  }
+  void pwritev(const iovec *iov, int iovcnt, off_t offset){
+    File_op_scope st{stats_ptr(), File_op::pwritev, true};
+    uint64_t calls{0};
+    size_t n{transfer_v(iov, iovcnt, offset, false, calls)};
+    st.done(n, calls);
+  }
+
+  // true if the file was opened with 'm' and is mapped into memory
+  bool mapped() const {return map_ptr != nullptr;}
+
+#if defined(FILE_HANDLE_STATS)
+  // the counters of the I/O of this File_handle (see file_stats.h). Only with FILE_HANDLE_STATS
+  const File_stats& stats() const {
+    stats_->stdio_buffer = mapped() ? 0 : File_op_scope::buffer_size(file_ptr);
+    return *stats_;
+  }
+#endif
+
+  // the whole file, read-only, when mapped(). The bytes are valid until this File_handle is
+  // destroyed. Reading them doesn't move the reading position of fgets() and fread()
+  Byte_span bytes() const {
+    if(!mapped())
+      throw runtime_error("Error in File_handle::bytes(). The file is not mapped.");
+    return Byte_span{reinterpret_cast<const unsigned char*>(map_ptr), map_bytes};
+  }
+
+  // Tell the OS how the mapping will be read. sequential makes it read ahead more and
+  // drop the pages behind, random stops reading ahead (which only wastes the disk for
+  // scattered lookups), and willneed starts reading the whole file now. They are only hints,
+  // so this does nothing if the file is not mapped.
+  void advise(Advice a){
+    if(!mapped())
+      return;
+    int flag{a == Advice::sequential ? MADV_SEQUENTIAL
+	: a == Advice::random ? MADV_RANDOM
+	: a == Advice::willneed ? MADV_WILLNEED : MADV_NORMAL};
+    if(madvise(map_ptr, map_bytes, flag) != 0)
+      throw runtime_error("Error in File_handle::advise(). madvise() failed.");
+  }
+
+private:
+  FILE *file_ptr;
+  vector<char> buffer;		// the buffer given to setvbuf(), if buffer_bytes > 0
+  char *map_ptr{nullptr};	// the mapping of the file, if mapped()
+  size_t map_bytes{0};
+  size_t pos{0};		// the reading position in the mapping
+#if defined(FILE_HANDLE_STATS)
+  unique_ptr<File_stats> stats_{new File_stats};
+  File_stats* stats_ptr() const {return stats_.get();}
+#else
+  File_stats* stats_ptr() const {return nullptr;}
+#endif
+
+  // pread() without counting, adding the system calls to calls
+  size_t pread_all(void *var_ptr, size_t read_bytes, off_t offset, uint64_t& calls) const {
+    if(mapped()){
+      if(offset < 0)
+	throw runtime_error("Error in File_handle::pread(). Negative offset.");
+      size_t from{min(static_cast<size_t>(offset), map_bytes)};
+      size_t n{min(read_bytes, map_bytes - from)};
+      memcpy(var_ptr, map_ptr + from, n);
+      return n;
+    }
+    char *p{static_cast<char*>(var_ptr)};
+    size_t done{0};
+    while(done < read_bytes){
+      ssize_t n{::pread(fileno(), p + done, read_bytes - done, offset + done)};
+      ++calls;
+      if(n < 0 && errno == EINTR)
+	continue;
+      if(n < 0)
+	throw runtime_error("Error in File_handle::pread(). Reading failed.");
+      if(n == 0)
+	break;			// the end of the file
+      done += n;
+    }
+    return done;
+  }
+
+  // readv/writev of all the bytes of iov (at the current position of the descriptor if offset
+  // is -1), and return the bytes transferred (less than all only by reading the end of file).
+  // The system calls are added to calls
+  size_t transfer_v(const iovec *iov, int iovcnt, off_t offset, bool reading,
+		    uint64_t& calls) const {
+    if(reading && mapped()){
+      size_t done{0};
+      for(int i=0; i<iovcnt; ++i){
+	size_t n{pread_all(iov[i].iov_base, iov[i].iov_len, offset + done, calls)};
+	done += n;
+	if(n < iov[i].iov_len)
+	  break;
+      }
+      return done;
+    }
+    // the system call may stop in the middle of a buffer, so the iovecs are adjusted
+    vector<iovec> rest(iov, iov + iovcnt);
+    size_t first{0}, done{0};
+    while(first < rest.size()){
+      int cnt{static_cast<int>(min(rest.size() - first, static_cast<size_t>(IOV_MAX)))};
+      ssize_t n;
+      if(offset < 0)
+	n = reading ? ::readv(fileno(), &rest[first], cnt) : ::writev(fileno(), &rest[first], cnt);
+      else
+	n = reading ? ::preadv(fileno(), &rest[first], cnt, offset + done)
+	  : ::pwritev(fileno(), &rest[first], cnt, offset + done);
+      ++calls;
+      if(n < 0 && errno == EINTR)
+	continue;
+      if(n < 0 || (n == 0 && !reading))
+	throw runtime_error(reading ? "Error in File_handle::preadv(). Reading failed."
+			    : "Error in File_handle::writev(). Writing failed.");
+      if(n == 0)
+	break;			// the end of the file
+      done += n;
+      size_t k{static_cast<size_t>(n)};
+      while(first < rest.size() && k >= rest[first].iov_len){	// the buffers done
+	k -= rest[first].iov_len;
+	++first;
+      }
+      if(first < rest.size()){	// the buffer done partly
+	rest[first].iov_base = static_cast<char*>(rest[first].iov_base) + k;
+	rest[first].iov_len -= k;
+      }
+    }
+    return done;
+  }
+
+  // the mode for fopen(), which doesn't know 'm' outside glibc
+  static string without_m(string mode){
+    mode.erase(remove(mode.begin(), mode.end(), 'm'), mode.end());
+    return mode;
+  }
+
+  // map the file if it is a regular file of 1 byte or more. Otherwise leave it unmapped, and
+  // it is read through the FILE*
+  void map_file(){
+    struct stat st;
+    if(fstat(fileno(), &st) != 0 || !S_ISREG(st.st_mode) || st.st_size == 0)
+      return;
+    void* p{mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fileno(), 0)};
+    if(p == MAP_FAILED)
+      return;
+    map_ptr = static_cast<char*>(p);
+    map_bytes = static_cast<size_t>(st.st_size);
+    // most files are read from the start to the end
+    madvise(map_ptr, map_bytes, MADV_SEQUENTIAL);
+  }
+};
+
+#endif // FILE_HANDLE_GUARD
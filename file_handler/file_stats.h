@@ -0,0 +1,276 @@
+
+#ifndef FILE_STATS_GUARD
+#define FILE_STATS_GUARD 1
+
+#include "std_lib_facilities.h"
+#include<cstdio>
+#include<cstdint>
+#include<chrono>
+#include<sstream>
+#include<iomanip>
+
+// Counters of the I/O of 1 File_handle: for each operation, the calls, the bytes, the system
+// calls, and a histogram of the latency. They are compiled in only with
+//   make STATS=-DFILE_HANDLE_STATS
+// (or -DFILE_HANDLE_STATS in any build), and then File_handle::stats() gives them, and
+// text() and json() print them:
+//   File_handle fh{"log.txt", "r"};
+//   ... (read the file)
+//   cout << fh.stats().text();
+// Without the macro, File_handle has no counters at all, and File_op_scope below is an empty
+// class whose calls the compiler removes, so there is nothing to pay.
+//
+// The cost when it is compiled in: reading the clock costs 20 to 40ns, which is as long as a
+// short fgets() itself, so only 1 of every FILE_HANDLE_STATS_SAMPLE calls (64 by default) of
+// each operation is timed, and the histogram is of those calls. The calls and the bytes are
+// counted for every call. fgetc() and fputc() (a few ns each) are counted but never timed.
+// An untimed call only tests the count of calls and adds to the calls and the bytes, about 2ns
+// (bench_stats.cpp). That is under 2% of a call of 100ns or more (a read of 4KB, or any call
+// that makes a system call), but 3-8% of an fwrite() or fread() of 16 bytes from the buffer
+// (30ns), which can hardly do less and still count every call. For such calls, read larger
+// pieces (read_array() of record_io.h, Line_reader), or count only some of the runs.
+// The system calls of fgets(), fread(), fwrite() etc. happen inside stdio, which doesn't tell
+// them, so they are estimated from the bytes and the size of the buffer of the FILE* (on glibc;
+// not counted on other C libraries): reading or writing a file from the start to the end makes
+// 1 read() or write() per buffer of bytes. (Looking at the buffer at every call to count them
+// exactly costs more than the rest of the counters.) The positional and vectored functions
+// (pread() etc.) and flush() count their system calls exactly.
+// The counters of the positional functions (pread(), pwrite(), preadv(), pwritev()), which
+// many threads may call at the same time, are added atomically. The others are only added by
+// the thread using the File_handle, so they are plain adds, without the lock of the bus. So
+// read stats() from that thread, or after it is done.
+
+#if !defined(FILE_HANDLE_STATS_SAMPLE)
+#define FILE_HANDLE_STATS_SAMPLE 64
+#endif
+static_assert((FILE_HANDLE_STATS_SAMPLE & (FILE_HANDLE_STATS_SAMPLE - 1)) == 0,
+	      "FILE_HANDLE_STATS_SAMPLE must be a power of 2");
+
+enum class File_op {fgetc, fputc, fgets, fputs, fread, fwrite, flush, pread, pwrite, writev,
+		    preadv, pwritev, count};
+
+inline const char* file_op_name(File_op op){
+  const char* names[]{"fgetc", "fputc", "fgets", "fputs", "fread", "fwrite", "flush", "pread",
+		      "pwrite", "writev", "preadv", "pwritev"};
+  return names[static_cast<int>(op)];
+}
+
+// a histogram of latencies in ns. The buckets are 4 for each power of 2 (1, 1.25, 1.5, 1.75
+// times it), so a percentile is within 25% of the true one
+class Latency_histogram {
+public:
+  static constexpr int buckets{4*41};	// up to 2^42 ns (over an hour)
+
+  void add(uint64_t ns, bool shared){bump(counts[bucket(ns)], 1, shared);}
+  uint64_t total() const;
+  // the lower bound of the bucket of the q-th quantile (q is 0 to 1), 0 if empty
+  uint64_t quantile(double q) const;
+  uint64_t count(int b) const {return counts[b];}
+  static uint64_t lower_bound(int b){
+    if(b < 4)
+      return b;
+    int e{b/4 + 1};
+    return static_cast<uint64_t>(4 + b%4) << (e - 2);
+  }
+
+  // add v to c. shared: other threads may add to c at the same time
+  static void bump(uint64_t& c, uint64_t v, bool shared){
+    if(shared)
+      __atomic_fetch_add(&c, v, __ATOMIC_RELAXED);
+    else
+      c += v;
+  }
+  // read c, which other threads may add to at the same time if shared
+  static uint64_t load(const uint64_t& c, bool shared){
+    return shared ? __atomic_load_n(&c, __ATOMIC_RELAXED) : c;
+  }
+
+private:
+  uint64_t counts[buckets]{};
+
+  static int bucket(uint64_t ns){
+    if(ns < 4)
+      return static_cast<int>(ns);
+    int e{63 - __builtin_clzll(ns)};	// the highest bit, 2 or more
+    int b{4*(e - 1) + static_cast<int>((ns >> (e - 2)) & 3)};
+    return min(b, buckets - 1);
+  }
+};
+
+inline uint64_t Latency_histogram::total() const {
+  uint64_t t{0};
+  for(int b=0; b<buckets; ++b)
+    t += count(b);
+  return t;
+}
+
+inline uint64_t Latency_histogram::quantile(double q) const {
+  uint64_t t{total()};
+  if(t == 0)
+    return 0;
+  uint64_t rank{static_cast<uint64_t>(q*(t - 1))}, seen{0};
+  for(int b=0; b<buckets; ++b){
+    seen += count(b);
+    if(seen > rank)
+      return lower_bound(b);
+  }
+  return lower_bound(buckets - 1);
+}
+
+struct Op_stats {
+  uint64_t calls{0};
+  uint64_t bytes{0};
+  uint64_t syscalls{0};
+  uint64_t timed_ns{0};		// the sum of the timed calls
+  Latency_histogram latency;		// of the timed calls
+};
+
+class File_stats {
+public:
+  const Op_stats& op(File_op o) const {return ops[static_cast<int>(o)];}
+  Op_stats& op(File_op o){return ops[static_cast<int>(o)];}
+  // the system calls of o (estimated for the operations through the buffer of stdio)
+  uint64_t op_syscalls(File_op o) const;
+  uint64_t syscalls() const;
+
+  size_t stdio_buffer{0};	// the size of the buffer of the FILE* (0 if unknown or mapped)
+
+  // a table of the operations that were called, with the latency percentiles in ns
+  string text() const;
+  // {"sample_every":64,"syscalls":N,"ops":{"fgets":{"calls":..,"bytes":..,"syscalls":..,
+  //  "latency_ns":{"timed":..,"mean":..,"p50":..,"p90":..,"p99":..,"max":..}},...}}
+  string json() const;
+
+private:
+  Op_stats ops[static_cast<int>(File_op::count)];
+};
+
+inline uint64_t File_stats::op_syscalls(File_op o) const {
+  const Op_stats& st{op(o)};
+  switch(o){
+  case File_op::fgetc: case File_op::fgets: case File_op::fread:
+    return stdio_buffer ? (st.bytes + stdio_buffer - 1)/stdio_buffer : 0;
+  case File_op::fputc: case File_op::fputs: case File_op::fwrite:
+    return stdio_buffer ? st.bytes/stdio_buffer : 0;
+  default:
+    return st.syscalls;
+  }
+}
+
+inline uint64_t File_stats::syscalls() const {
+  uint64_t s{0};
+  for(int i=0; i<static_cast<int>(File_op::count); ++i)
+    s += op_syscalls(static_cast<File_op>(i));
+  return s;
+}
+
+inline string File_stats::text() const {
+  ostringstream os;
+  os << left << setw(8) << "op" << right << setw(12) << "calls" << setw(14) << "bytes"
+     << setw(10) << "syscalls" << setw(10) << "mean(ns)" << setw(9) << "p50" << setw(9) << "p90"
+     << setw(9) << "p99" << setw(11) << "max" << '\n';
+  for(int i=0; i<static_cast<int>(File_op::count); ++i){
+    const Op_stats& o{ops[i]};
+    uint64_t calls{o.calls};
+    if(calls == 0)
+      continue;
+    uint64_t timed{o.latency.total()};
+    os << left << setw(8) << file_op_name(static_cast<File_op>(i)) << right << setw(12) << calls
+       << setw(14) << o.bytes << setw(10)
+       << op_syscalls(static_cast<File_op>(i));
+    if(timed == 0)
+      os << setw(10) << "-" << setw(9) << "-" << setw(9) << "-" << setw(9) << "-" << setw(11) << "-";
+    else
+      os << setw(10) << o.timed_ns/timed << setw(9)
+	 << o.latency.quantile(0.5) << setw(9) << o.latency.quantile(0.9) << setw(9)
+	 << o.latency.quantile(0.99) << setw(11) << o.latency.quantile(1);
+    os << '\n';
+  }
+  os << "system calls: " << syscalls() << " (1 of every " << FILE_HANDLE_STATS_SAMPLE
+     << " calls timed)\n";
+  return os.str();
+}
+
+inline string File_stats::json() const {
+  ostringstream os;
+  os << "{\"sample_every\":" << FILE_HANDLE_STATS_SAMPLE << ",\"syscalls\":" << syscalls()
+     << ",\"ops\":{";
+  bool first{true};
+  for(int i=0; i<static_cast<int>(File_op::count); ++i){
+    const Op_stats& o{ops[i]};
+    uint64_t calls{o.calls};
+    if(calls == 0)
+      continue;
+    uint64_t timed{o.latency.total()};
+    os << (first ? "" : ",") << '"' << file_op_name(static_cast<File_op>(i)) << "\":{\"calls\":"
+       << calls << ",\"bytes\":" << o.bytes << ",\"syscalls\":"
+       << op_syscalls(static_cast<File_op>(i)) << ",\"latency_ns\":{\"timed\":" << timed
+       << ",\"mean\":" << (timed ? o.timed_ns/timed : 0)
+       << ",\"p50\":" << o.latency.quantile(0.5) << ",\"p90\":" << o.latency.quantile(0.9)
+       << ",\"p99\":" << o.latency.quantile(0.99) << ",\"max\":" << o.latency.quantile(1)
+       << "}}";
+    first = false;
+  }
+  os << "}}";
+  return os.str();
+}
+
+#if defined(FILE_HANDLE_STATS)
+// Counting 1 call of an operation: made at the start of the call, and done() at the end with
+// the bytes and the system calls. A call which throws is not counted
+class File_op_scope {
+public:
+  File_op_scope(File_stats* s, File_op o, bool shared = false)
+    : stats{s->op(o)}, share{shared},
+      timed{o != File_op::fgetc && o != File_op::fputc
+	    && (Latency_histogram::load(stats.calls, shared)
+		& (FILE_HANDLE_STATS_SAMPLE - 1)) == 0},
+      t0{timed ? now_ns() : 0}
+  {}
+
+  void done(uint64_t bytes, uint64_t syscalls){
+    if(__builtin_expect(timed, 0))
+      add_time(stats, t0, share);
+    Latency_histogram::bump(stats.calls, 1, share);
+    Latency_histogram::bump(stats.bytes, bytes, share);
+    Latency_histogram::bump(stats.syscalls, syscalls, share);
+  }
+
+  // the size of the buffer of f, and if it has bytes to write
+#if defined(__GLIBC__)
+  static size_t buffer_size(FILE* f){return f->_IO_buf_base ? f->_IO_buf_end - f->_IO_buf_base : 0;}
+  static bool write_pending(FILE* f){return f->_IO_write_ptr > f->_IO_write_base;}
+#else
+  static size_t buffer_size(FILE*){return 0;}
+  static bool write_pending(FILE*){return true;}
+#endif
+
+private:
+  Op_stats& stats;
+  bool share;
+  bool timed;
+  uint64_t t0;			// now_ns() at the start of a timed call
+
+  // The timed calls are out of line, and static, so that no pointer to the scope escapes and
+  // the compiler keeps it in registers instead of on the stack of every call
+  __attribute__((noinline, cold)) static uint64_t now_ns(){
+    return static_cast<uint64_t>(chrono::duration_cast<chrono::nanoseconds>(
+	chrono::steady_clock::now().time_since_epoch()).count());
+  }
+  __attribute__((noinline, cold)) static void add_time(Op_stats& st, uint64_t t0, bool shared){
+    uint64_t ns{now_ns() - t0};
+    Latency_histogram::bump(st.timed_ns, ns, shared);
+    st.latency.add(ns, shared);
+  }
+};
+#else
+// nothing, to be removed by the compiler
+class File_op_scope {
+public:
+  File_op_scope(File_stats*, File_op, bool = false){}
+  void done(uint64_t, uint64_t){}
+  static bool write_pending(FILE*){return false;}
+};
+#endif
+
+#endif // FILE_STATS_GUARD
@@ -0,0 +1,157 @@
+
+#ifndef LINE_READER_GUARD
+#define LINE_READER_GUARD 1
+
+#include "std_lib_facilities.h"
+#include "file_handle.h"
+#include<cstring>		// for memchr(), memmove()
+#include<iterator>
+#include<string_view>		// C++17
+
+// Reading the lines of a File_handle without allocating or copying each line.
+// A line is a string_view into the buffer of the reader (or into the mapping, if the file is
+// opened with "rm"), without the '\n'. It is valid until the next line is read, so keep a copy
+// (string{line}) if it is needed longer.
+// File_handle::fgets() copies each line into a char array on the stack and then into the
+// string, and tells the end of the file by the string "EOF". Here, next() returns false at
+// the end of the file, and a range-for loop just stops:
+//   File_handle fh{"log.txt", "r"};
+//   for(string_view line : Line_reader{fh})
+//     ...
+// The '\n' is found by memchr(), which glibc implements with SIMD instructions (16 or 32 bytes
+// at a time), so a line costs little more than reading its bytes.
+// A line longer than the buffer makes the buffer grow to hold it, so there is no limit of the
+// length of a line except the memory. The last line doesn't need a '\n'.
+// For a file opened without 'm', the lines start from the current reading position of fh,
+// and fh must not be read by anything else while the reader is used. For a mapped file, they
+// start from the beginning of the file.
+class Line_reader {
+public:
+  explicit Line_reader(File_handle& f, size_t buffer_bytes = 1<<16);
+
+  // the next line into line. false at the end of the file
+  bool next(string_view& line);
+
+  // the number of lines read so far
+  size_t line_number() const {return lines;}
+
+  class iterator;
+  iterator begin();
+  iterator end();
+
+private:
+  File_handle& fh;
+  vector<char> buf;		// not used if the file is mapped
+  size_t b{0};			// the start of the next line in buf (or in the mapping)
+  size_t e{0};			// the end of the bytes in buf
+  size_t scanned{0};		// the bytes from b that are known not to have '\n'
+  bool eof{false};		// fh has no more bytes to read into buf
+  size_t lines{0};
+  Byte_span mapping{nullptr, 0};
+
+  bool next_mapped(string_view& line);
+  void refill();
+};
+
+// input iterator of the lines. Reading 1 line moves the reader, so 2 iterators of the same
+// reader are not independent, like istream_iterator
+class Line_reader::iterator {
+public:
+  using iterator_category = input_iterator_tag;
+  using value_type = string_view;
+  using difference_type = ptrdiff_t;
+  using pointer = const string_view*;
+  using reference = const string_view&;
+
+  iterator() : r{nullptr} {}	// end
+  explicit iterator(Line_reader* lr) : r{lr} {++*this;}
+
+  const string_view& operator*() const {return line;}
+  const string_view* operator->() const {return &line;}
+  iterator& operator++(){
+    if(!r->next(line))
+      r = nullptr;
+    return *this;
+  }
+  bool operator==(const iterator& o) const {return r == o.r;}
+  bool operator!=(const iterator& o) const {return r != o.r;}
+
+private:
+  Line_reader* r;
+  string_view line;
+};
+
+inline Line_reader::Line_reader(File_handle& f, size_t buffer_bytes)
+  : fh{f}
+{
+  if(fh.mapped())
+    mapping = fh.bytes();
+  else{
+    if(buffer_bytes == 0)
+      throw runtime_error("Error in Line_reader. The buffer size must be 1 byte or more.");
+    buf.resize(buffer_bytes);
+  }
+}
+
+inline Line_reader::iterator Line_reader::begin(){return iterator{this};}
+inline Line_reader::iterator Line_reader::end(){return iterator{};}
+
+// the lines are slices of the mapping itself
+inline bool Line_reader::next_mapped(string_view& line){
+  if(b == mapping.size())
+    return false;
+  const char* p{reinterpret_cast<const char*>(mapping.data()) + b};
+  size_t rest{mapping.size() - b};
+  const void* nl{memchr(p, '\n', rest)};
+  size_t len{nl ? static_cast<size_t>(static_cast<const char*>(nl) - p) : rest};
+  line = string_view{p, len};
+  b += nl ? len + 1 : len;
+  ++lines;
+  return true;
+}
+
+inline bool Line_reader::next(string_view& line){
+  if(fh.mapped())
+    return next_mapped(line);
+  while(true){
+    const char* p{buf.data() + b};
+    const void* nl{memchr(p + scanned, '\n', e - b - scanned)};
+    if(nl != nullptr){
+      size_t len{static_cast<size_t>(static_cast<const char*>(nl) - p)};
+      line = string_view{p, len};
+      b += len + 1;
+      scanned = 0;
+      ++lines;
+      return true;
+    }
+    scanned = e - b;		// memchr() doesn't look at these bytes again
+    if(eof){
+      if(b == e)
+	return false;
+      line = string_view{p, e - b};	// the last line without '\n'
+      b = e;
+      scanned = 0;
+      ++lines;
+      return true;
+    }
+    refill();
+  }
+}
+
+// move the unfinished line to the start of buf, and read more bytes after it. If the line
+// already fills buf, buf grows twice, so that a long line costs amortized O(1) per byte
+inline void Line_reader::refill(){
+  if(b > 0){
+    memmove(buf.data(), buf.data() + b, e - b);
+    e -= b;
+    b = 0;
+  }
+  if(e == buf.size())
+    buf.resize(buf.size()*2);
+  size_t n{fh.fread(buf.data() + e, buf.size() - e)};
+  if(n == 0)
+    eof = true;
+  e += n;
+}
+
+#endif // LINE_READER_GUARD
@@ -0,0 +1,173 @@
+
+#ifndef LINE_SCANNER_GUARD
+#define LINE_SCANNER_GUARD 1
+
+#include "std_lib_facilities.h"
+#include "file_handle.h"
+#include<cstdint>
+#include<cstring>		// for memchr(), memmove()
+#include<string_view>		// C++17
+#include<thread>
+#include<atomic>
+#include<exception>		// for exception_ptr
+#include<sys/stat.h>		// for fstat() (POSIX)
+
+// Scanning the lines of a big text file on many threads (counting, grepping, splitting etc).
+// The file is cut into byte ranges whose borders are just after a '\n', so that every line
+// is in exactly 1 range, and the threads take the ranges one by one and call a function for
+// each line of them. Each range has its own result, and the results are merged in the order
+// of the file at the end, so a result which keeps the lines in order (e.g. a vector of the
+// matched lines) comes out the same as by 1 thread:
+//   File_handle fh{"log.txt", "rb"};
+//   size_t errors{scan_lines(fh, size_t{0},
+//       [](size_t& n, string_view line){if(line.find("ERROR") != string_view::npos) ++n;},
+//       [](size_t& total, size_t& n){total += n;})};
+// There are more ranges than threads (ranges_per_thread for each), because lines of some
+// ranges take longer than others, and a thread which finishes early takes another range
+// instead of waiting.
+// The ranges are read by File_handle::pread(), which doesn't share the position of the file,
+// so the threads don't need a lock. If the file is opened with "rm", the lines are slices of
+// the mapping, without any copy. As in Line_reader, a line is a string_view without the '\n',
+// valid only during the call.
+
+// the bytes [begin, end) of a file, which start at the start of a line and end after a '\n'
+// (or at the end of the file)
+struct Line_range {
+  uint64_t begin;
+  uint64_t end;
+};
+
+namespace line_scanner_detail {
+  inline uint64_t file_bytes(const File_handle& fh){
+    if(fh.mapped())
+      return fh.bytes().size();
+    struct stat st;
+    if(fstat(fh.fileno(), &st) != 0)
+      throw runtime_error("Error in scan_lines(). Cannot get the file size.");
+    return static_cast<uint64_t>(st.st_size);
+  }
+
+  // the first start of a line at or after pos
+  inline uint64_t line_start(const File_handle& fh, uint64_t pos, uint64_t size){
+    if(pos == 0)
+      return 0;
+    char buf[4096];
+    // the line starts at pos if the byte before pos is '\n'
+    for(uint64_t p{pos - 1}; p < size; p += sizeof(buf)){
+      size_t n{fh.pread(buf, static_cast<size_t>(min<uint64_t>(sizeof(buf), size - p)),
+			static_cast<off_t>(p))};
+      if(n == 0)
+	break;
+      const void* nl{memchr(buf, '\n', n)};
+      if(nl != nullptr)
+	return p + (static_cast<const char*>(nl) - buf) + 1;
+    }
+    return size;
+  }
+
+  // call on_line(result, line) for each line of r
+  template<typename R, typename F>
+  void scan_range(const File_handle& fh, Line_range r, R& result, F& on_line, vector<char>& buf){
+    if(fh.mapped()){
+      const char* p{reinterpret_cast<const char*>(fh.bytes().data()) + r.begin};
+      const char* end{reinterpret_cast<const char*>(fh.bytes().data()) + r.end};
+      while(p < end){
+	const char* nl{static_cast<const char*>(memchr(p, '\n', end - p))};
+	size_t len{nl ? static_cast<size_t>(nl - p) : static_cast<size_t>(end - p)};
+	on_line(result, string_view{p, len});
+	p += nl ? len + 1 : len;
+      }
+      return;
+    }
+    // as Line_reader::refill(): the unfinished line is moved to the start of buf, and buf
+    // grows if 1 line doesn't fit
+    uint64_t off{r.begin};
+    size_t b{0}, e{0};
+    while(true){
+      const void* nl{memchr(buf.data() + b, '\n', e - b)};
+      if(nl != nullptr){
+	size_t len{static_cast<size_t>(static_cast<const char*>(nl) - (buf.data() + b))};
+	on_line(result, string_view{buf.data() + b, len});
+	b += len + 1;
+	continue;
+      }
+      if(off == r.end){
+	if(b < e)		// the last line of the file without '\n'
+	  on_line(result, string_view{buf.data() + b, e - b});
+	return;
+      }
+      memmove(buf.data(), buf.data() + b, e - b);
+      e -= b;
+      b = 0;
+      if(e == buf.size())
+	buf.resize(buf.size()*2);
+      size_t want{static_cast<size_t>(min<uint64_t>(buf.size() - e, r.end - off))};
+      size_t n{fh.pread(buf.data() + e, want, static_cast<off_t>(off))};
+      if(n == 0)
+	throw runtime_error("Error in scan_lines(). The file became shorter while scanning.");
+      e += n;
+      off += n;
+    }
+  }
+}
+
+// about n ranges of lines of the whole file, of about the same size (fewer if the lines are
+// long, because a range has at least 1 line)
+inline vector<Line_range> split_lines(const File_handle& fh, size_t n){
+  using namespace line_scanner_detail;
+  uint64_t size{file_bytes(fh)};
+  n = max<size_t>(n, 1);
+  vector<Line_range> ranges;
+  uint64_t begin{0};
+  for(size_t i=1; i<=n && begin < size; ++i){
+    uint64_t end{i == n ? size : line_start(fh, max(begin, size/n*i), size)};
+    if(end > begin)
+      ranges.push_back(Line_range{begin, end});
+    begin = end;
+  }
+  return ranges;
+}
+
+// Call on_line(result, line) for each line of fh, on num_threads threads, and return init
+// merged with the results of all the ranges in the order of the file by merge(total, part).
+// Each range starts with a copy of init, so init should be an "empty" result (0, an empty
+// container). on_line must be safe to call on different results at the same time.
+// An exception of on_line or merge is thrown again here (the first one, if many).
+template<typename R, typename F, typename M>
+R scan_lines(const File_handle& fh, R init, F on_line, M merge,
+	     int num_threads = static_cast<int>(thread::hardware_concurrency()),
+	     size_t ranges_per_thread = 8, size_t buffer_bytes = 1<<20){
+  num_threads = max(num_threads, 1);
+  if(buffer_bytes == 0)
+    throw runtime_error("Error in scan_lines(). The buffer size must be 1 byte or more.");
+  vector<Line_range> ranges{split_lines(fh, num_threads*max<size_t>(ranges_per_thread, 1))};
+  num_threads = max(1, min(num_threads, static_cast<int>(ranges.size())));
+  vector<R> results(ranges.size(), init);
+  vector<exception_ptr> errors(num_threads);
+  atomic<size_t> next{0};
+  auto work = [&](int t){
+    try{
+      vector<char> buf(fh.mapped() ? 0 : buffer_bytes);
+      for(size_t i{next++}; i < ranges.size(); i = next++)
+	line_scanner_detail::scan_range(fh, ranges[i], results[i], on_line, buf);
+    }
+    catch(...){
+      errors[t] = current_exception();
+      next = ranges.size();	// the others stop after their current range
+    }
+  };
+  vector<thread> threads;
+  for(int t=1; t<num_threads; ++t)
+    threads.emplace_back(work, t);
+  work(0);
+  for(thread& th : threads)
+    th.join();
+  for(exception_ptr& e : errors)
+    if(e)
+      rethrow_exception(e);
+  for(R& r : results)
+    merge(init, r);
+  return init;
+}
+
+#endif // LINE_SCANNER_GUARD
@@ -1,95 +1,15 @@
 
 
 #include "std_lib_facilities.h"
-
-
-// Since fstream already practices RAII, I use C-style file management (FILE*, fopen(), fclose())
-struct File_handle {
-  File_handle(const string& fn, const string& file_mode)
-    : file_ptr{fopen(fn.c_str(), file_mode.c_str())}
-  {
-    if(file_ptr == nullptr){	// check if the file is properly opened
-      throw runtime_error("Error. File cannot be opened properly.");
-    }
-  }
-  ~File_handle(){fclose(file_ptr);}
-
-  // the member functions are from the usual ways of using a file pointer.
-  // Inspired from chapter 14 of another book "Practical C Programming"
-  char fgetc(){return ::fgetc(file_ptr);} // read 1 character from ASCII (text) file
-  // Aside: the :: qualifier without preceding namespace tells the compiler to look for the
-  //        global namespace first. Without this ::, since this class also has the function
-  //        named fgetc(), and compiler look from close namespace, it matches
-  //        File_handle::fgetc() before matching global (original) fgetc(). To match the
-  //        original one first, I put :: before fgetc().
-  // https://stackoverflow.com/questions/4269034/
-  void fputc(char ch){::fputc(ch, file_ptr);} // write 1 character to ASCII file
-
-  // read size characters or until it hits '\n'. If ::fgets() hits the end of file, cstr stores
-  // null
-  void fgets(string& s, int size=1){	      
-    char cstr[size+1];
-    if(::fgets(cstr, size+1, file_ptr) == nullptr){
-    // Those +1 is for the null character '\0' or 0. ::fgets(cstr, size, file_ptr) reads size-1
-    // characters, and fill the last character with '\0'. So, to read size characters, we need
-    // to put size+1 in fgets(). Then, it reads size characters, and add '\0' to the last, and
-    // store it to cstr. Thus, cstr also needs size+1 characters.
-
-      // ::fgets() returns nullptr if it hits the end of file
-      s = "EOF";
-      return;
-    }
-    s = cstr;		// it seems there is the appropriate assignment operator from
-    // char* to string
-  }
-
-  // write the string to file
-  void fputs(const string& s){
-    if(::fputs(s.c_str(), file_ptr)){}
-    // ::fputs() returns EOF (== -1 here) if error occured. Otherwise, it returns a non-negative
-    // number.
-    else
-      throw runtime_error("Error in File_handle::fputs().");
-  }
-
-  // read binary file
-  void fread(void *var_ptr, size_t read_bytes){
-    // read "read_bytes" bytes from the current reading position
-    char c[read_bytes];			// to check read error, I don't immediately store the read
-    // bytes to var_ptr
-    // If we use void* vp; instead of actually allocating some block of memory, when we try
-    // to store read bytes to vp, segmentation fault happens, because there is nowhere to store
-    // the read bytes.
-    // Since bytes are not text characters, we don't have to care '\0' and add 1 to the
-    // char array size
-    
-    size_t read_size{::fread(c, 1, read_bytes, file_ptr)};
-    // check file error
-    if(ferror(file_ptr))
-      throw runtime_error("Error in File_handle::fread(). Reading failed.");
-
-    // it's not always the case that the requested bytes are read. The byte size of the actually 
-    // read bytes are stored in read_size.
-    char *var_ptr_char{static_cast<char*>(var_ptr)}; // since void* cannot do subscripting
-    // or arithmetic operation (e.g. it is invalid to do var_ptr[i] or var_ptr+i, since the
-    // compiler cannot know the byte size of 1 element of the object pointed to by void*, thus
-    // it cannot know how many bytes the program should forward the bytes with var_ptr+1),
-    // I first convert var_ptr's type to char*. They (var_ptr_char and var_ptr) point to
-    // the same address, but unlike void*, char* knows the byte size of 1 element of char, so
-    // I can do subscripting or arithmetic operation on var_ptr_char now.
-    for(int i=0; i<read_size; ++i)
-      var_ptr_char[i] = c[i];
-  }
-
-  // write to binary file
-  void fwrite(void *var_ptr, size_t write_bytes){
-    ::fwrite(var_ptr, 1, write_bytes, file_ptr);
-    if(ferror(file_ptr))
-      throw runtime_error("Error in File_handle::fwrite(). Writing failed.");
-  } 
-private:
-  FILE *file_ptr;
-};
+#include "file_handle.h"
+#include "line_reader.h"
+#include "line_scanner.h"
+#include "async_io.h"
+#include "record_io.h"
+#include "compressed_file.h"
+#include "wal.h"
+#include "../My_Allocator/Vector.h"
+#include "../Vector3/vector3.h"
 
 
 int main()
@@ -142,7 +62,149 @@ int main()
     //    exist on some platform. For example, on Windows, in text writing mode, '\n' seems to 
     //    be automatically converted into '\r\n'.
     // https://stackoverflow.com/questions/229924/
-    
+
+    cout << dec;		// hex was set above
+    // mode "rm" maps the file into memory, and fgets() reads the lines from the mapping
+    {
+      File_handle fhm{"test.txt", "rm"};
+      cout << "mapped: " << fhm.mapped() << ", " << fhm.bytes().size() << " bytes: ";
+      for(fhm.fgets(l, 100); l != "EOF"; fhm.fgets(l, 100))
+	cout << l;
+      cout << '\n';
+      // a file of /proc has size 0 in fstat(), so it cannot be mapped, and is read through
+      // the buffer as usual
+      File_handle fhp{"/proc/self/stat", "rm"};
+      fhp.fgets(l, 10);
+      cout << "/proc/self/stat mapped: " << fhp.mapped() << ", starts with " << l << '\n';
+    }
+
+    // Line_reader gives each line as a string_view without '\n', and stops at the end of the
+    // file, even if the last line is "EOF"
+    {
+      File_handle fhw{"test_lines.txt", "w"};
+      fhw.fputs("first line\n\nthird line, after an empty line\nEOF");
+    }
+    {
+      File_handle fhr{"test_lines.txt", "r"};
+      Line_reader lr{fhr, 8};	// a tiny buffer, to see the long lines are read correctly
+      for(string_view line : lr)
+	cout << lr.line_number() << ": [" << line << "]\n";
+    }
+
+    // Async_io reads at offsets of a file without blocking. The result comes to a future (or
+    // a callback) after submit()
+    {
+      File_handle fha{"test_lines.txt", "r"};
+      Async_io io;
+      char first[5]{}, last[4]{};
+      future<ssize_t> f1{io.read(fha.fileno(), first, 4, 0)};
+      future<ssize_t> f2{io.read(fha.fileno(), last, 3, 44)};
+      io.submit();
+      cout << "Async_io (" << (io.backend() == Async_io::Backend::io_uring ? "io_uring"
+			       : "thread_pool") << "): " << f1.get() << " bytes [" << first
+	   << "], " << f2.get() << " bytes [" << last << "]\n";
+    }
+
+    // write_array() writes a whole container in 1 call, with a header and a checksum, and
+    // read_array() reads it back into any container of the same element type
+    {
+      Vector3<double> v3{1.5, 2.5, 3.5};
+      {
+	File_handle fhw{"test_records.bin", "wb"};
+	write_array(fhw, v3);
+      }
+      File_handle fhr{"test_records.bin", "rb"};
+      Vector<double> v;
+      read_array(fhr, v);
+      cout << "read_array(): " << v.size() << " records:";
+      for(int i=0; i<v.size(); ++i)
+	cout << ' ' << v[i];
+      cout << '\n';
+    }
+
+    // Compressed_writer compresses in independent blocks (here of 64 bytes, to have a few),
+    // and Compressed_reader can decompress any block alone
+    {
+      string text;
+      for(int i=0; i<20; ++i)
+	text += "line " + to_string(i) + " of a compressible file\n";
+      Lz_codec lz;
+      {
+	Compressed_writer w{"test_compressed.bin", lz, 64};
+	w.write(text.data(), text.size());
+      }
+      Compressed_reader r{"test_compressed.bin"};
+      vector<char> all{r.read_all()};
+      cout << "Compressed_reader (" << r.codec_name() << "): " << r.raw_bytes() << " bytes in "
+	   << r.blocks() << " blocks, the same: " << (string(all.begin(), all.end()) == text)
+	   << ", the block of byte 300 starts at byte " << r.block_raw_offset(r.find_block(300))
+	   << '\n';
+    }
+
+    // writev() writes a header and its payload by 1 system call, and pread() reads at an
+    // offset without moving the position of the file
+    {
+      {
+	File_handle fhv{"test_vectored.bin", "wb"};
+	uint32_t head{5};
+	char payload[]{"hello"};
+	iovec iov[]{{&head, sizeof(head)}, {payload, 5}};
+	fhv.writev(iov, 2);
+      }
+      File_handle fhv{"test_vectored.bin", "rb"};
+      char back[6]{};
+      size_t n{fhv.pread(back, 5, sizeof(uint32_t))};
+      cout << "pread() after writev(): " << n << " bytes, \"" << back << "\"\n";
+    }
+
+    // scan_lines() calls a function for each line on many threads, and merges the results in
+    // the order of the file. Here, the lengths of the lines of test_lines.txt by 2 threads
+    {
+      File_handle fhs{"test_lines.txt", "r"};
+      vector<size_t> lengths{scan_lines(fhs, vector<size_t>{},
+	  [](vector<size_t>& v, string_view line){v.push_back(line.size());},
+	  [](vector<size_t>& total, vector<size_t>& part){
+	    total.insert(total.end(), part.begin(), part.end());}, 2)};
+      cout << "scan_lines(): the lengths of the lines:";
+      for(size_t l : lengths)
+	cout << ' ' << l;
+      cout << '\n';
+    }
+
+    // Wal_writer appends records which are on the disk when append() returns. A crash while
+    // writing leaves a torn record at the end (here, made by cutting the file), and reopening
+    // the log cuts it, so the complete records are kept
+    {
+      remove("test_wal.log");
+      {
+	Wal_writer w{"test_wal.log"};
+	w.append("move north");
+	w.append("shoot 7");
+	w.append("move east");
+      }
+      if(truncate("test_wal.log", wal_detail::file_size("test_wal.log") - 2) != 0)
+	error("cannot truncate test_wal.log");
+      Wal_writer w{"test_wal.log"};
+      w.append("move west");
+      Wal_reader r{"test_wal.log"};
+      vector<char> rec;
+      cout << "Wal_reader:";
+      while(r.next(rec))
+	cout << " [" << string(rec.begin(), rec.end()) << "]";
+      cout << '\n';
+    }
+
+#if defined(FILE_HANDLE_STATS)
+    // with make STATS=-DFILE_HANDLE_STATS, each File_handle counts its calls, bytes and system
+    // calls, and times some of the calls
+    {
+      File_handle fhs{"test_lines.txt", "r"};
+      for(fhs.fgets(l, 100); l != "EOF"; fhs.fgets(l, 100))
+	;
+      cout << fhs.stats().text();
+    }
+#endif
+
     return 0;
   }
   catch(exception& e){
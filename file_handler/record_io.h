@@ -0,0 +1,152 @@
+
+#ifndef RECORD_IO_GUARD
+#define RECORD_IO_GUARD 1
+
+#include "std_lib_facilities.h"
+#include "file_handle.h"
+#include "crc32c.h"
+#include<cstdint>
+#include<cstring>		// for memcmp()
+#include<type_traits>
+#include<limits>
+#include<algorithm>		// for reverse()
+
+// Writing an array of records (trivially copyable structs, or numbers) to a binary file at
+// once, and reading it back.
+// Writing each field of each struct by fwrite() costs a function call (and a check of the
+// buffer) per field, and the reader has to repeat the same fields in the same order. Here the
+// whole array is written as it is in memory, by 1 fwrite() after the header (::fwrite() writes
+// a large array directly, without copying it into the buffer of the FILE*).
+// An array in the file is:
+//   Record_header (32 bytes)
+//   count records of record_bytes bytes each
+// and a file can have many arrays one after another.
+// The records are written in the byte order of the writing machine, and byte_order in the
+// header tells it. If the reader has the other byte order, each record is converted by
+// byte_swap(T&): numbers are converted by the overload below, and for a struct, define
+//   void byte_swap(Point& p){byte_swap(p.x); byte_swap(p.y);}
+// next to the struct (it is found by argument-dependent lookup). Without it, reading such a
+// file throws.
+// The layout of a struct (padding, sizeof) can differ between compilers; record_bytes catches
+// a different sizeof, but not a different order of the fields.
+struct Record_header {
+  char magic[4];		// "RECS"
+  uint16_t version;
+  uint16_t byte_order;		// byte_order_mark, as written by the writer
+  uint32_t record_bytes;	// sizeof(T)
+  uint32_t checksum;		// CRC-32C of the records, as the bytes in the file
+  uint64_t count;		// the number of records
+  uint64_t reserved;		// 0, for later versions
+
+  static constexpr uint16_t current_version{1};
+  static constexpr uint16_t byte_order_mark{0x0102};  // 0x0201 if read on the other order
+};
+static_assert(sizeof(Record_header) == 32, "Record_header must be 32 bytes without padding");
+
+// reverse the bytes of a number, to convert it between little-endian and big-endian
+template<typename T>
+enable_if_t<is_arithmetic<T>::value> byte_swap(T& x){
+  unsigned char* p{reinterpret_cast<unsigned char*>(&x)};
+  reverse(p, p + sizeof(T));
+}
+
+namespace record_io_detail {
+  // true if byte_swap(T&) is defined
+  template<typename T, typename = void>
+  struct has_byte_swap : false_type {};
+  template<typename T>
+  struct has_byte_swap<T, void_t<decltype(byte_swap(declval<T&>()))>> : true_type {};
+
+  inline void swap_header(Record_header& h){
+    byte_swap(h.version);
+    byte_swap(h.byte_order);
+    byte_swap(h.record_bytes);
+    byte_swap(h.checksum);
+    byte_swap(h.count);
+  }
+
+  // read and check the header of an array of records of record_bytes bytes. swapped is set
+  // to true if the file has the other byte order
+  inline Record_header read_header(File_handle& fh, size_t record_bytes, bool& swapped){
+    Record_header h;
+    fh.read_exact(&h, sizeof(h));
+    if(memcmp(h.magic, "RECS", 4) != 0)
+      error("Error in read_array(). It is not an array of records.");
+    swapped = h.byte_order != Record_header::byte_order_mark;
+    if(swapped)
+      swap_header(h);
+    if(h.byte_order != Record_header::byte_order_mark)
+      error("Error in read_array(). The byte order in the header is broken.");
+    if(h.version != Record_header::current_version)
+      error("Error in read_array(). Unknown version.");
+    if(h.record_bytes != record_bytes)
+      error("Error in read_array(). The size of a record is different (another type?).");
+    return h;
+  }
+
+  // read count records into p, and check them
+  template<typename T>
+  void read_records(File_handle& fh, const Record_header& h, bool swapped, T* p){
+    size_t bytes{h.count*sizeof(T)};
+    fh.read_exact(p, bytes);
+    if(crc32c(p, bytes) != h.checksum)
+      error("Error in read_array(). The checksum doesn't match (the file is damaged).");
+    if(swapped){
+      if constexpr(has_byte_swap<T>::value){
+	for(size_t i=0; i<h.count; ++i)
+	  byte_swap(p[i]);
+      }
+      else
+	error("Error in read_array(). The file has the other byte order, and byte_swap() is "
+	      "not defined for this type.");
+    }
+  }
+}
+
+// write the n records from p as 1 array
+template<typename T>
+void write_array(File_handle& fh, const T* p, size_t n){
+  static_assert(is_trivially_copyable<T>::value, "a record is written as its bytes");
+  size_t bytes{n*sizeof(T)};
+  Record_header h{{'R','E','C','S'}, Record_header::current_version,
+      Record_header::byte_order_mark, static_cast<uint32_t>(sizeof(T)), crc32c(p, bytes),
+      static_cast<uint64_t>(n), 0};
+  fh.write_all(&h, sizeof(h));
+  fh.write_all(p, bytes);
+}
+
+// read 1 array of exactly n records into p
+template<typename T>
+void read_array(File_handle& fh, T* p, size_t n){
+  static_assert(is_trivially_copyable<T>::value, "a record is read as its bytes");
+  bool swapped;
+  Record_header h{record_io_detail::read_header(fh, sizeof(T), swapped)};
+  if(h.count != n)
+    error("Error in read_array(). The number of records is different.");
+  record_io_detail::read_records(fh, h, swapped, p);
+}
+
+// write all the elements of a container which has data() and size(), like vector<T>,
+// Vector<T,A> (My_Allocator/Vector.h) and Vector3<T> (Vector3/vector3.h), as 1 array
+template<typename C>
+void write_array(File_handle& fh, const C& c){
+  write_array(fh, c.data(), static_cast<size_t>(c.size()));
+}
+
+// read 1 array into a container which has data(), size() and resize(), replacing its
+// elements
+template<typename C>
+void read_array(File_handle& fh, C& c){
+  using T = remove_pointer_t<decltype(c.data())>;
+  static_assert(is_trivially_copyable<T>::value, "a record is read as its bytes");
+  bool swapped;
+  Record_header h{record_io_detail::read_header(fh, sizeof(T), swapped)};
+  // the sizes of Vector<T,A> and Vector3<T> are int
+  using Size = decltype(c.size());
+  if(h.count > static_cast<uint64_t>(numeric_limits<Size>::max()))
+    error("Error in read_array(). Too many records for this container.");
+  c.resize(static_cast<Size>(h.count));
+  record_io_detail::read_records(fh, h, swapped, c.data());
+}
+
+#endif // RECORD_IO_GUARD
@@ -0,0 +1,288 @@
+
+#ifndef WAL_GUARD
+#define WAL_GUARD 1
+
+#include "std_lib_facilities.h"
+#include "file_handle.h"
+#include "crc32c.h"
+#include<cstdint>
+#include<cstring>		// for memcmp(), memcpy()
+#include<mutex>
+#include<condition_variable>
+#include<exception>		// for exception_ptr
+#include<unistd.h>		// for fdatasync(), truncate() (POSIX)
+#include<sys/stat.h>		// for stat() (POSIX)
+
+// An append-only log of records (a write-ahead log), which keeps every record append() has
+// returned for, even if the program or the machine crashes right after it.
+// Game states or updates of containers are appended as records of bytes, and after a crash,
+// Wal_reader reads back every record that was completely written, in the order of append().
+// The file is:
+//   Wal_header (8 bytes): "WLOG" and the version
+//   records: Wal_record_head (8 bytes: the length of the payload, and the CRC-32C of the
+//            length and the payload) and the payload, for each record
+// A crash in the middle of writing leaves a "torn" record at the end: a part of the head or
+// of the payload, or bytes which the file system never wrote. Its length or its CRC doesn't
+// match, so the reader stops there, and Wal_writer cuts the file there before appending more
+// (recover_wal()). A broken record in the middle of the file (a damaged disk) looks the same,
+// so the records after it are lost too.
+//
+// When a record is on the disk depends on the Sync_policy:
+//   none:  append() only writes the record to the OS. It survives a crash of the program,
+//          but not of the OS or a power loss, until sync() or the OS writes it (seconds).
+//   every: append() calls fdatasync() for each record by itself. Every record is on the
+//          disk when append() returns, but each costs a whole flush of the disk, and the
+//          threads wait for each other's.
+//   group: the same guarantee as every, but the threads that append at the same time share
+//          1 fdatasync() ("group commit"). The first thread that needs a write becomes the
+//          leader: it takes all the records waiting, writes them by 1 pwrite() and syncs them,
+//          while the next records gather for the next leader. With 1 thread it is the same as
+//          every, and with many, the cost of 1 fdatasync() is divided among them.
+// fdatasync() (not fsync()) skips the metadata that is not needed to read the data back, such
+// as the modification time.
+
+enum class Sync_policy {none, every, group};
+
+struct Wal_header {
+  char magic[4];		// "WLOG"
+  uint16_t version;
+  uint16_t reserved;
+  static constexpr uint16_t current_version{1};
+};
+struct Wal_record_head {
+  uint32_t bytes;		// of the payload
+  uint32_t crc;			// CRC-32C of bytes and the payload
+};
+static_assert(sizeof(Wal_header) == 8 && sizeof(Wal_record_head) == 8, "no padding");
+
+namespace wal_detail {
+  inline uint32_t record_crc(uint32_t bytes, const void* p){
+    return crc32c(p, bytes, crc32c(&bytes, sizeof(bytes)));
+  }
+
+  // the size of fn, or -1 if it doesn't exist
+  inline long long file_size(const string& fn){
+    struct stat st;
+    if(stat(fn.c_str(), &st) != 0)
+      return -1;
+    return st.st_size;
+  }
+}
+
+// Reading the records of a log from the start, until the end or a torn record
+class Wal_reader {
+public:
+  explicit Wal_reader(const string& fn);
+
+  // the next record into rec. false at the end of the valid records
+  bool next(vector<char>& rec);
+  // the bytes of the file up to the end of the last record read (after next() returned
+  // false, the valid part of the file), and the number of the records read
+  uint64_t valid_bytes() const {return offset;}
+  uint64_t records() const {return count;}
+  // true if next() stopped at a torn or broken record, rather than at the end of the file
+  bool torn() const {return torn_tail;}
+
+private:
+  File_handle fh;
+  uint64_t size;
+  uint64_t offset{sizeof(Wal_header)};
+  uint64_t count{0};
+  bool torn_tail{false};
+};
+
+inline Wal_reader::Wal_reader(const string& fn)
+  : fh{fn, "rb", 1<<16}, size{static_cast<uint64_t>(max(wal_detail::file_size(fn), 0LL))}
+{
+  Wal_header h;
+  if(size < sizeof(h) || fh.fread(&h, sizeof(h)) != sizeof(h) || memcmp(h.magic, "WLOG", 4) != 0
+     || h.version != Wal_header::current_version)
+    throw runtime_error("Error in Wal_reader. " + fn + " is not a log of this version.");
+}
+
+inline bool Wal_reader::next(vector<char>& rec){
+  if(torn_tail)
+    return false;
+  Wal_record_head h;
+  if(size - offset < sizeof(h)){
+    torn_tail = offset != size;
+    return false;
+  }
+  if(fh.fread(&h, sizeof(h)) != sizeof(h) || h.bytes > size - offset - sizeof(h)){
+    torn_tail = true;
+    return false;
+  }
+  rec.resize(h.bytes);
+  if(fh.fread(rec.data(), h.bytes) != h.bytes || wal_detail::record_crc(h.bytes, rec.data()) != h.crc){
+    torn_tail = true;
+    return false;
+  }
+  offset += sizeof(h) + h.bytes;
+  ++count;
+  return true;
+}
+
+// Make fn ready to append: create it with the header if it doesn't exist (or a crash left only
+// a part of the header), and cut a torn record at the end. Returns the size of the file after.
+// A file which is not a log throws, rather than being overwritten.
+inline uint64_t recover_wal(const string& fn){
+  long long size{wal_detail::file_size(fn)};
+  if(size < static_cast<long long>(sizeof(Wal_header))){
+    Wal_header h{{'W','L','O','G'}, Wal_header::current_version, 0};
+    if(size > 0){
+      // only the start of the same header is a header left by a crash. Anything else is not
+      // a log, and is not overwritten
+      char part[sizeof(h)];
+      File_handle old{fn, "rb"};
+      if(old.fread(part, static_cast<size_t>(size)) != static_cast<size_t>(size)
+	 || memcmp(part, &h, static_cast<size_t>(size)) != 0)
+	throw runtime_error("Error in recover_wal(). " + fn + " is not a log of this version.");
+    }
+    File_handle fh{fn, "wb"};
+    fh.write_all(&h, sizeof(h));
+    fh.flush();
+    if(fdatasync(fh.fileno()) != 0)
+      throw runtime_error("Error in recover_wal(). Cannot sync " + fn + ".");
+    return sizeof(h);
+  }
+  Wal_reader r{fn};
+  vector<char> rec;
+  while(r.next(rec))
+    ;
+  if(r.torn() && truncate(fn.c_str(), static_cast<off_t>(r.valid_bytes())) != 0)
+    throw runtime_error("Error in recover_wal(). Cannot cut the torn tail of " + fn + ".");
+  return r.valid_bytes();
+}
+
+// Appending records to a log, from any number of threads
+class Wal_writer {
+public:
+  // opens (or creates) fn after recover_wal()
+  explicit Wal_writer(const string& fn, Sync_policy p = Sync_policy::group);
+  Wal_writer(const Wal_writer&) = delete;
+  Wal_writer& operator=(const Wal_writer&) = delete;
+
+  // append a record of n bytes, and return the end of the record in the file (a log sequence
+  // number: the records before it are also written). When it returns, the record is on the
+  // disk, or only in the OS for Sync_policy::none. After a write fails, every append throws
+  uint64_t append(const void* p, size_t n);
+  uint64_t append(const string& s){return append(s.data(), s.size());}
+
+  // put every record appended so far on the disk (for Sync_policy::none)
+  void sync();
+
+  uint64_t bytes() const;	// the size of the file, including all the records appended
+  uint64_t syncs() const;	// the number of fdatasync() calls so far
+
+private:
+  uint64_t appended;		// the end of the last record (declared before fh, because
+				// recover_wal() creates the file)
+  File_handle fh;
+  Sync_policy policy;
+  mutable mutex m;
+  condition_variable written_cv;
+  vector<char> pending;		// the records waiting for the next leader
+  vector<char> batch;		// the records being written by the leader
+  uint64_t written;		// the end of the bytes written (and synced, unless none)
+  bool leader_busy{false};
+  uint64_t sync_count{0};
+  exception_ptr failure;	// the error of a write, thrown to every append after it
+
+  void write_until(unique_lock<mutex>& lk, uint64_t end);
+  void sync_fd(){
+    if(fdatasync(fh.fileno()) != 0)
+      throw runtime_error("Error in Wal_writer. fdatasync() failed.");
+  }
+};
+
+inline Wal_writer::Wal_writer(const string& fn, Sync_policy p)
+  : appended{recover_wal(fn)}, fh{fn, "r+b"}, policy{p}, written{appended}
+{
+}
+
+inline uint64_t Wal_writer::append(const void* p, size_t n){
+  if(n > UINT32_MAX)
+    throw runtime_error("Error in Wal_writer::append(). A record must be under 4GB.");
+  Wal_record_head h{static_cast<uint32_t>(n), wal_detail::record_crc(static_cast<uint32_t>(n), p)};
+  unique_lock<mutex> lk{m};
+  if(failure)
+    rethrow_exception(failure);
+  size_t at{pending.size()};
+  pending.resize(at + sizeof(h) + n);
+  memcpy(pending.data() + at, &h, sizeof(h));
+  memcpy(pending.data() + at + sizeof(h), p, n);
+  appended += sizeof(h) + n;
+  uint64_t end{appended};
+  write_until(lk, end);
+  return end;
+}
+
+// Group commit: wait until the bytes up to end are written, and write them as the leader if
+// no other thread is writing. Sync_policy::every has no group: each leader takes only 1
+// record, since the other threads can't add to pending while it holds m
+inline void Wal_writer::write_until(unique_lock<mutex>& lk, uint64_t end){
+  while(written < end){
+    if(failure)
+      rethrow_exception(failure);
+    if(leader_busy){
+      written_cv.wait(lk);
+      continue;
+    }
+    leader_busy = true;
+    batch.swap(pending);
+    uint64_t at{written};
+    exception_ptr e;
+    if(policy == Sync_policy::every){
+      try{
+	fh.pwrite(batch.data(), batch.size(), static_cast<off_t>(at));
+	sync_fd();
+      }
+      catch(...){
+	e = current_exception();
+      }
+    }
+    else{
+      lk.unlock();		// the next records gather in pending meanwhile
+      try{
+	fh.pwrite(batch.data(), batch.size(), static_cast<off_t>(at));
+	if(policy == Sync_policy::group)
+	  sync_fd();
+      }
+      catch(...){
+	e = current_exception();
+      }
+      lk.lock();
+    }
+    if(e)
+      failure = e;
+    else{
+      written = at + batch.size();
+      if(policy != Sync_policy::none)
+	++sync_count;
+    }
+    batch.clear();
+    leader_busy = false;
+    written_cv.notify_all();
+  }
+}
+
+inline void Wal_writer::sync(){
+  unique_lock<mutex> lk{m};
+  write_until(lk, appended);
+  if(failure)
+    rethrow_exception(failure);
+  sync_fd();
+  ++sync_count;
+}
+
+inline uint64_t Wal_writer::bytes() const {
+  lock_guard<mutex> lk{m};
+  return appended;
+}
+
+inline uint64_t Wal_writer::syncs() const {
+  lock_guard<mutex> lk{m};
+  return sync_count;
+}
+
+#endif // WAL_GUARD
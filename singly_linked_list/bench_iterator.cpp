@@ -0,0 +1,58 @@
+
+// Traversal microbenchmark of sList<Elem>'s iterators.
+// It walks the same sList<int> many times with checked and unchecked iterators, and prints
+// the time per element in ns. std::forward_list<int> is measured as a reference.
+// usage: ./bench_iterator [number of elements] [number of traversals]
+
+#include "singly_linked_list.h"
+#include<forward_list>
+#include<chrono>
+
+// Walk [b, e) "rounds" times, and return ns per element.
+// sum is returned through the reference, and printed in main(), so that the compiler cannot
+// remove the loop.
+template<typename Iter>
+double traverse(Iter b, Iter e, unsigned long n, int rounds, long long& sum){
+  auto t0 = chrono::steady_clock::now();
+  for(int r=0; r<rounds; ++r)
+    for(Iter p=b; p!=e; ++p)
+      sum += *p;
+  auto t1 = chrono::steady_clock::now();
+  return chrono::duration<double, nano>(t1-t0).count() / (double(n)*rounds);
+}
+
+int main(int argc, char* argv[])
+  try{
+    unsigned long n{argc>1 ? stoul(argv[1]) : 1000000};
+    int rounds{argc>2 ? stoi(argv[2]) : 20};
+
+    sList<int> slst;
+    forward_list<int> stl_lst;
+    for(unsigned long i=0; i<n; ++i)
+      slst.push_front(static_cast<int>(i));
+    for(unsigned long i=0; i<n; ++i)
+      stl_lst.push_front(static_cast<int>(i));
+
+    long long sum{0};
+    // warm up the cache and the page tables once, before measuring
+    traverse(slst.unchecked_begin(), slst.unchecked_end(), n, 1, sum);
+
+    double checked{traverse(slst.checked_begin(), slst.checked_end(), n, rounds, sum)};
+    double unchecked{traverse(slst.unchecked_begin(), slst.unchecked_end(), n, rounds, sum)};
+    double stl{traverse(stl_lst.begin(), stl_lst.end(), n, rounds, sum)};
+
+    cout << "elements: " << n << ", traversals: " << rounds << endl;
+    cout << "sList<int>::checked_iterator   : " << checked << " ns/element\n";
+    cout << "sList<int>::unchecked_iterator : " << unchecked << " ns/element\n";
+    cout << "std::forward_list<int>         : " << stl << " ns/element\n";
+    cout << "(checksum " << sum << ")\n";
+    return 0;
+  }
+  catch(exception& e){
+    cerr << e.what() << endl;
+    return 1;
+  }
+  catch(...){
+    cerr << "Unknown exception is caught\n";
+    return 1;
+  }
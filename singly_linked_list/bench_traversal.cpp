@@ -0,0 +1,78 @@
+
+// Benchmark of the prefetching traversal helpers and compact() of sList<Elem>.
+// To imitate a list built in random insertion order, the links of a freshly built sList are
+// re-linked in a random order, so that the traversal order has nothing to do with the order
+// of the links in memory. Then the list is scanned before and after compact().
+// usage: ./bench_traversal [number of elements] [number of traversals]
+
+#include "singly_linked_list.h"
+#include<chrono>
+#include<algorithm>
+
+// return ns per element of running f() "rounds" times over n elements
+template<typename F>
+double measure(unsigned long n, int rounds, F f){
+  auto t0 = chrono::steady_clock::now();
+  for(int r=0; r<rounds; ++r)
+    f();
+  auto t1 = chrono::steady_clock::now();
+  return chrono::duration<double, nano>(t1-t0).count() / (double(n)*rounds);
+}
+
+// link the links of slst in a random order (slst.first and the links are public)
+void scatter(sList<long long>& slst){
+  vector<sLink<long long>*> links;
+  for(sLink<long long>* p=slst.first; p!=0; p=p->succ)
+    links.push_back(p);
+  shuffle(links.begin(), links.end(), mt19937_64{2024});
+  for(size_t i=0; i<links.size(); ++i)
+    links[i]->succ = (i+1<links.size()) ? links[i+1] : 0;
+  slst.first = links.front();
+  slst.last = links.back();
+}
+
+void run(sList<long long>& slst, unsigned long n, int rounds, const string& label){
+  long long sum{0};
+  long long missing{-1};	// not in the list, so find() scans all the elements
+  double plain{measure(n, rounds, [&]{
+	for(auto p=slst.unchecked_begin(); p!=slst.unchecked_end(); ++p) sum += *p;})};
+  double each{measure(n, rounds, [&]{slst.for_each([&](long long e){sum += e;});})};
+  double acc{measure(n, rounds, [&]{sum += slst.accumulate(0LL);})};
+  double fnd{measure(n, rounds, [&]{sum += (slst.find(missing) == slst.end());})};
+  cout << label << endl;
+  cout << "  iterator loop (no prefetch) : " << plain << " ns/element\n";
+  cout << "  for_each()                  : " << each << " ns/element\n";
+  cout << "  accumulate()                : " << acc << " ns/element\n";
+  cout << "  find() (not found)          : " << fnd << " ns/element\n";
+  cout << "  (checksum " << sum << ")\n";
+}
+
+int main(int argc, char* argv[])
+  try{
+    unsigned long n{argc>1 ? stoul(argv[1]) : 4000000};
+    int rounds{argc>2 ? stoi(argv[2]) : 5};
+
+    sList<long long> slst;
+    for(unsigned long i=0; i<n; ++i)
+      slst.push_back(i);
+    scatter(slst);
+    cout << "elements: " << n << ", traversals: " << rounds << endl;
+
+    run(slst, n, rounds, "### links in random memory order");
+
+    auto t0 = chrono::steady_clock::now();
+    slst.compact();
+    auto t1 = chrono::steady_clock::now();
+    cout << "compact(): " << chrono::duration<double, milli>(t1-t0).count() << " ms\n";
+
+    run(slst, n, rounds, "### after compact()");
+    return 0;
+  }
+  catch(exception& e){
+    cerr << e.what() << endl;
+    return 1;
+  }
+  catch(...){
+    cerr << "Unknown exception is caught\n";
+    return 1;
+  }
@@ -143,6 +143,21 @@ int main()
     cout << "slst.size()= " << slst.size() << ", " << "slst2.size()= " << slst2.size() << ", "
 	 << "slst3.size()= " << slst3.size() << endl;
 
+    // test the prefetching traversal helpers and compact()
+    cout << "### test for_each(), find(), accumulate(), and compact()\n";
+    slst3.for_each([](int& e){e *= 2;});
+    print_container(slst3);	// 22 42 62 82 102
+    cout << "slst3.accumulate(0)= " << slst3.accumulate(0) << endl; // 310
+    cout << "*slst3.find(62)= " << *slst3.find(62) << endl;
+    if(slst3.find(63) == slst3.end())
+      cout << "63 is not found in slst3\n";
+    slst3.compact();		// now the 5 links are next to each other
+    slst3.push_back(122);	// a link allocated by new, after the block
+    slst3.erase(slst3.find(42)); // a link in the block
+    print_container(slst3);	// 22 62 82 102 122
+    cout << "slst3.begin().curr= " << slst3.begin().curr << ", the 2nd element= "
+	 << slst3.begin()->succ << endl;
+
     return 0;
   }
   catch(exception& e){
@@ -3,6 +3,24 @@
 #define SINGLY_LINKED_LIST_GUARD 1
 
 #include "std_lib_facilities.h"
+#include<new>			// for placement new in compact()
+#include<functional>		// for std::less<> in delete_link()
+
+// Checking policy of sList<Elem>'s iterators.
+// A checked iterator behaves like the original one: ++end() goes back to begin() (circulation),
+// dereferencing end() throws runtime_error, and comparing iterators of different sLists throws
+// as well. An unchecked iterator only chases succ pointers: it doesn't look into the sList on
+// each step, and doesn't test for 0 before dereferencing, so ++end() or *end() is undefined,
+// like STL's iterators. In a traversal loop, the unchecked one compiles to just p = p->succ.
+// By default, iterator and const_iterator are checked, and in release builds (-DNDEBUG) they
+// become unchecked. SLIST_CHECKED_ITERATOR can be defined to 0 or 1 to choose it explicitly.
+#ifndef SLIST_CHECKED_ITERATOR
+#ifdef NDEBUG
+#define SLIST_CHECKED_ITERATOR 0
+#else
+#define SLIST_CHECKED_ITERATOR 1
+#endif
+#endif
 
 template<typename Elem>
 struct sLink {			// no prev pointer, unlike Link<> for List<Elem> above
@@ -27,17 +45,17 @@ public:
   // Like the original List<> class above, I prepared both first and last for sList<> as well
 
   sList()
-    : first{0}, last{first}, sz{0}
+    : first{0}, last{first}, sz{0}, pool{nullptr}, pool_sz{0}
   {}
   
-  sList(initializer_list<Elem> lst) : first{0}, last{first}, sz{0}
+  sList(initializer_list<Elem> lst) : first{0}, last{first}, sz{0}, pool{nullptr}, pool_sz{0}
   {
     for(const auto e : lst)
       push_back(e);
   }
   
   // copy constructor
-  sList(const sList<Elem>& lst) : first{0}, last{first}, sz{0}
+  sList(const sList<Elem>& lst) : first{0}, last{first}, sz{0}, pool{nullptr}, pool_sz{0}
   {
     // create the same number of sLink<Elem> objects, and copy lst's elements
     for(const auto a : lst)	// a is Elem type, not sLink<Elem> type
@@ -53,15 +71,19 @@ public:
   }
   
   // move constructor
-  sList(const sList<Elem>&& lst) : first{0}, last{first}, sz{0}
+  sList(const sList<Elem>&& lst) : first{0}, last{first}, sz{0}, pool{nullptr}, pool_sz{0}
   {
     // rob lst of its elements
     first = lst.first;
     last = lst.last;
     sz = lst.sz;
+    pool = lst.pool;
+    pool_sz = lst.pool_sz;
 
     // to prevent lst's elements from being destroyed in lst's destructor, set lst's sz to 0
     lst.sz = 0;
+    lst.pool = nullptr;		// the same for the block made by compact()
+    lst.pool_sz = 0;
   }
   // move assignment operator
   sList<Elem>& operator=(const sList<Elem>&& a){
@@ -72,35 +94,54 @@ public:
     first = a.first;
     last = a.last;
     sz = a.sz;
+    pool = a.pool;
+    pool_sz = a.pool_sz;
     // to prevent a's elements from being destroyed in a's destructor, set a's sz to 0
     a.sz = 0;
+    a.pool = nullptr;
+    a.pool_sz = 0;
 
     return *this;
   }
   
   ~sList(){
-    iterator p{begin()}, p2{iterator(this, p.curr->succ)};
-    for(int i=0; i<sz; ++i){			     // delete except end() element
-      delete p.curr;
+    sLink<Elem>* p{first};
+    for(size_type i=0; i<sz; ++i){		     // delete except end() element
+      sLink<Elem>* p2{p->succ};
+      delete_link(p);
       p = p2;
-      ++p2;
-      // if I didn't have p2, and only had p, since delete p.curr; deleted sLink<> pointed to
-      // by p already, ++p would not succeed.
+      // if I didn't have p2, and only had p, since delete p; deleted sLink<> pointed to
+      // by p already, p = p->succ would not succeed.
+      // I use raw pointers here instead of iterators, because with unchecked iterators,
+      // ++end() is not allowed (the last p2 is end()).
     }
     // to use this destructor in move and copy assignment operators, reset first, last and sz
     first = 0;			// 0 means pointing to end() element
     last = 0;
     sz = 0;
+    ::operator delete(pool);	// the links in it were already destroyed by delete_link()
+    pool = nullptr;
+    pool_sz = 0;
   }
   
-  class iterator;
+  template<bool checked> class basic_iterator;
+  using iterator = basic_iterator<(SLIST_CHECKED_ITERATOR != 0)>;
+  using checked_iterator = basic_iterator<true>;
+  using unchecked_iterator = basic_iterator<false>;
   iterator begin(){return iterator(this, first);}
   iterator end(){return iterator(this, 0);}
 
-  class const_iterator;
+  template<bool checked> class basic_const_iterator;
+  using const_iterator = basic_const_iterator<(SLIST_CHECKED_ITERATOR != 0)>;
   const_iterator begin()const {return const_iterator(this, first);}
   const_iterator end()const {return const_iterator(this, 0);}
 
+  // iterators with an explicitly chosen policy, regardless of SLIST_CHECKED_ITERATOR
+  checked_iterator checked_begin(){return checked_iterator(this, first);}
+  checked_iterator checked_end(){return checked_iterator(this, 0);}
+  unchecked_iterator unchecked_begin(){return unchecked_iterator(this, first);}
+  unchecked_iterator unchecked_end(){return unchecked_iterator(this, 0);}
+
   size_type size(){return sz;}
   
   iterator insert(iterator p, const Elem& v); // insert v into list before p
@@ -117,6 +158,24 @@ public:
   
   void pop_front();		  // remove the 1st element
   void pop_back();		  // remove the last element
+
+  // Traversal helpers for long lists. A traversal of a linked list waits for a cache miss
+  // on every link, so these helpers run a 2nd pointer "dist" links ahead of the current one,
+  // and prefetch the links it reaches. The misses of the links ahead then overlap with the
+  // work on the current link. It helps more when f does more work per element.
+  template<typename F>
+  void for_each(F f, int dist=default_prefetch_dist); // call f(elem) on each element in order
+  iterator find(const Elem& v, int dist=default_prefetch_dist); // 1st element ==v, or end()
+  template<typename T>
+  T accumulate(T init, int dist=default_prefetch_dist) const; // init + sum of all elements
+
+  void compact();
+  // Re-allocate all the links in traversal order into 1 contiguous block, so that later
+  // traversals read memory sequentially (and the hardware prefetcher works). All iterators
+  // to this list become invalid.
+  // Links inserted after compact() are allocated by new as usual.
+
+  static constexpr int default_prefetch_dist{8};
   
   Elem& front(){
     if(begin()==end()) throw("Error in list<Elem>::front(). No element exists in this list.");
@@ -136,6 +195,42 @@ public:
   
 private:
   size_type sz;		// stores the number of elements (sLink<Elem>)
+
+  sLink<Elem>* pool;		// the block of links made by compact(), or nullptr
+  size_type pool_sz;		// the number of links the block can hold
+
+  // The 2nd pointer of the prefetching traversals (for_each(), find(), and accumulate()). It
+  // starts dist links ahead of the first link, and each link it reaches is prefetched, so by
+  // the time the traversal comes to a link, the link is likely in the cache already.
+  struct Prefetch_cursor {
+    sLink<Elem>* ahead;
+    Prefetch_cursor(sLink<Elem>* first, int dist)
+      : ahead{first}
+    {
+      for(int i=0; i<dist && ahead!=0; ++i){
+	__builtin_prefetch(ahead);
+	ahead = ahead->succ;
+      }
+    }
+    // called once per link of the traversal
+    void advance(){
+      if(ahead != 0){
+	__builtin_prefetch(ahead->succ);
+	// prefetch the link after next, so that the next "ahead = ahead->succ" hits the cache.
+	// __builtin_prefetch() of GCC/Clang never faults, even for 0
+	ahead = ahead->succ;
+      }
+    }
+  };
+  // A link in the block cannot be deleted one by one, so every link is freed by delete_link()
+  // (instead of delete), and the block itself is freed in the destructor or the next compact()
+  void delete_link(sLink<Elem>* p){
+    less<const sLink<Elem>*> before;	// total order, even for pointers to different objects
+    if(!before(p, pool) && before(p, pool+pool_sz))
+      p->~sLink();			// in the block. Only destroy it
+    else
+      delete p;
+  }
 };
 
 // Since a singly-linked list doesn't have a pointer to its previous sLink element, I change the
@@ -211,8 +306,6 @@ typename sList<Elem>::iterator sList<Elem>::find_previous(iterator p){
 // Since I felt erase() is one of the central operation to list, I didn't eliminate this.
 template<typename Elem>
 typename sList<Elem>::iterator sList<Elem>::erase(iterator p){
-  iterator k{p}; ++k;			// points to the next element to p. Used as return value
-
   if(begin()==end())
     throw runtime_error("Error in sList<Elemt>::erase(). No element exists in this list.");
 
@@ -244,8 +337,11 @@ typename sList<Elem>::iterator sList<Elem>::erase(iterator p){
   else{				// when p==end()
     throw runtime_error("Error in sList<Elemt>::erase(). The given iterator points to end()");
   }
-  
-  delete p.curr;
+
+  iterator k(this, p.curr->succ);	// points to the next element to p. Used as return value
+  // k is made here, after p is checked not to be end(), since ++end() is not allowed for
+  // unchecked iterators
+  delete_link(p.curr);
   --sz;
   return k;
 }
@@ -295,7 +391,7 @@ void sList<Elem>::pop_front(){
 
   if(sz == 1){
     // in this case, both first and last are moved to pointing to the end() element
-    delete first;
+    delete_link(first);
     first = 0;			// iterator(this,0) == end()
     last = 0;
   }
@@ -303,67 +399,157 @@ void sList<Elem>::pop_front(){
     // in this case, only first pointer is moved to the successor
     sLink<Elem>* p{first};
     first = first->succ;
-    delete p;
+    delete_link(p);
   }
   --sz;
 }
 
+// The prefetching traversals, with Prefetch_cursor (see the private section of sList)
+template<typename Elem>
+template<typename F>
+void sList<Elem>::for_each(F f, int dist){
+  sLink<Elem>* p{first};
+  Prefetch_cursor ahead{first, dist};
+  for(size_type i=0; i<sz; ++i){
+    ahead.advance();
+    f(p->val);
+    p = p->succ;
+  }
+}
+
+template<typename Elem>
+typename sList<Elem>::iterator sList<Elem>::find(const Elem& v, int dist){
+  sLink<Elem>* found{0};			// 0 == end()
+  sLink<Elem>* p{first};
+  Prefetch_cursor ahead{first, dist};
+  // the same as for_each() above, but stops at the 1st match
+  for(; p!=0; p=p->succ){
+    ahead.advance();
+    if(p->val == v){
+      found = p;
+      break;
+    }
+  }
+  return iterator(this, found);
+}
+
+template<typename Elem>
+template<typename T>
+T sList<Elem>::accumulate(T init, int dist) const {
+  sLink<Elem>* p{first};
+  Prefetch_cursor ahead{first, dist};
+  for(size_type i=0; i<sz; ++i){
+    ahead.advance();
+    init = init + p->val;
+    p = p->succ;
+  }
+  return init;
+}
+
+template<typename Elem>
+void sList<Elem>::compact(){
+  if(sz == 0)
+    return;
+
+  // allocate the memory for sz links at once, and construct the links in traversal order
+  // by placement new (like allocator<T>::construct() does)
+  sLink<Elem>* block{static_cast<sLink<Elem>*>(::operator new(sz*sizeof(sLink<Elem>)))};
+  sLink<Elem>* p{first};
+  size_type i{0};
+  try{
+    for(; i<sz; ++i, p=p->succ)
+      new(&block[i]) sLink<Elem>(p->val); // copy constructor of Elem is assumed to exist
+  }
+  catch(...){
+    // destroy the links constructed so far, and leave this list as it was
+    for(size_type j=0; j<i; ++j)
+      block[j].~sLink();
+    ::operator delete(block);
+    throw;
+  }
+  for(i=0; i<sz; ++i)
+    block[i].succ = (i+1<sz) ? &block[i+1] : 0;
+  // free the old links (some of them may be in the block of the previous compact())
+  p = first;
+  for(i=0; i<sz; ++i){
+    sLink<Elem>* p2{p->succ};
+    delete_link(p);
+    p = p2;
+  }
+  ::operator delete(pool);
+
+  pool = block;
+  pool_sz = sz;
+  first = block;
+  last = &block[sz-1];
+}
+
 // pop_back() can also be implemented with find_previous() member, but I decided not to do that,
 // since pop_back() seems not as essential an operator as erase()
 
 // Since in singly-linked list, there is no back pointers, I deleted the backward operator --
+// "checked" is a compile-time constant, so in unchecked iterators, the if-sentences on it are
+// removed by the compiler, and no check is left in the traversal.
 template<typename Elem>
-class sList<Elem>::iterator {
+template<bool checked>
+class sList<Elem>::basic_iterator {
 public:
   sLink<Elem>* curr;		// current link
   const sList<Elem>* lst;
   
-  iterator(const sList<Elem>* llst, sLink<Elem>* p) : curr{p}, lst{llst} {}
+  basic_iterator(const sList<Elem>* llst, sLink<Elem>* p) : curr{p}, lst{llst} {}
 
-  iterator& operator++(){	// forward
-    if(lst->end().curr == curr){				   // <= curr==0
-      curr = lst->begin().curr;
+  basic_iterator& operator++(){	// forward
+    if(checked && curr == 0){	// <= curr==0 means end(). I don't build lst->end() to see it
+      curr = lst->first;
       return *this;
     }
     curr = curr->succ; return *this;
   }
   Elem& operator*(){
-    if(curr == 0)
+    if(checked && curr == 0)
       throw runtime_error("Error in Lst<Elem>::iterator's dereference operator *. You try to dereference end() element.");
     return curr->val;}			   // dereference (*iterator)
   sLink<Elem>* operator->(){return curr;}
   
-  bool operator==(const iterator& b) const {return curr==b.curr;}
-  // I don't have to compare lst with b.lst, because if curr==b.curr, both iterators point to
-  // the same element, which must be in the same List<>
-  bool operator!=(const iterator& b) const {return !(*this==b);}
+  bool operator==(const basic_iterator& b) const {
+    if(checked && lst != b.lst)
+      throw runtime_error("Error in sList<Elem>::iterator's operator ==. The 2 iterators belong to different sLists.");
+    return curr==b.curr;}
+  // Unchecked iterators don't compare lst with b.lst, because if curr==b.curr, both iterators
+  // point to the same element, which must be in the same sList<>. But the 2 end() iterators
+  // of different sLists are both 0, so the checked ones catch that mistake.
+  bool operator!=(const basic_iterator& b) const {return !(*this==b);}
 };
 
 // removed operator--() from List<Elem>::const_iterator, and the rest is the same
 template<typename Elem>
-class sList<Elem>::const_iterator {
+template<bool checked>
+class sList<Elem>::basic_const_iterator {
 public:
   sLink<Elem>* curr;		// current link
   const sList<Elem>* lst;	// pointer to the list
   
-  const_iterator(const sList<Elem>* llst, sLink<Elem>* p) : curr{p}, lst{llst} {}
+  basic_const_iterator(const sList<Elem>* llst, sLink<Elem>* p) : curr{p}, lst{llst} {}
 
-  const_iterator operator++(){	 // forward
-    if(lst->end().curr == curr){				   // <= curr==0
-      curr = lst->begin().curr;
+  basic_const_iterator operator++(){	 // forward
+    if(checked && curr == 0){	// <= curr==0 means end()
+      curr = lst->first;
       return *this;
     }
     curr = curr->succ; return *this;
   }
   Elem operator*()const{
-    if(curr == 0) throw runtime_error("Error in Lst<Elem>::const_iterator's dereference operator *. You try to dereference end() element.");
+    if(checked && curr == 0) throw runtime_error("Error in Lst<Elem>::const_iterator's dereference operator *. You try to dereference end() element.");
     return curr->val;
   }			   // dereference (*iterator)
   const sLink<Elem>* operator->() const {return curr;}
 
-  bool operator==(const const_iterator& b) const
-  {return curr==b.curr && lst->first==b.lst->first;}
-  bool operator!=(const const_iterator& b) const {return !(*this==b);}
+  bool operator==(const basic_const_iterator& b) const {
+    if(checked && lst != b.lst)
+      throw runtime_error("Error in sList<Elem>::const_iterator's operator ==. The 2 iterators belong to different sLists.");
+    return curr==b.curr;}
+  bool operator!=(const basic_const_iterator& b) const {return !(*this==b);}
 };
 
 
@@ -0,0 +1,109 @@
+
+// Benchmark of Block_skip_list<T> against Skip_list<T> and Tower_skip_list<T>: memory per key
+// and the latency of find() of random keys, after inserting n distinct keys in random order.
+// The memory of Skip_list<T> is the growth of the resident set size (/proc/self/statm, so
+// Linux only) while building, so it includes the malloc overhead of each new. (It runs 1st,
+// so that the heap is not reused.) The other lists report the bytes of their nodes by
+// memory_bytes().
+// usage: ./bench_block [number of keys] [lists to run: s=Skip_list t=Tower b=Block]
+// e.g. ./bench_block 10000000 stb, ./bench_block 100000000 tb
+// (with 100M keys, Skip_list<T> needs about 10GB, and Tower_skip_list<T> about 4GB)
+
+#include "./skip_list.h"
+#include "./tower_skip_list.h"
+#include "./block_skip_list.h"
+#include<chrono>
+#include<deque>
+#include<fstream>
+
+double seconds_since(chrono::steady_clock::time_point t0){
+  return chrono::duration<double>(chrono::steady_clock::now()-t0).count();
+}
+
+// resident set size in bytes
+size_t rss(){
+  ifstream ifs{"/proc/self/statm"};
+  size_t total{0}, resident{0};
+  ifs >> total >> resident;
+  return resident * 4096;
+}
+
+void report(const string& label, size_t n, size_t mem, double build, double lookup){
+  cout << label << ": " << double(mem)/n << " bytes/key, insert " << build*1e9/n
+       << " ns/key, find " << lookup*1e9/n << " ns/key\n";
+}
+
+// n distinct keys in random order, and the same keys in another random order for find()
+void make_keys(size_t n, vector<long long>& keys, vector<long long>& queries){
+  keys.resize(n);
+  for(size_t i=0; i<n; ++i)
+    keys[i] = static_cast<long long>(i)*7 + 1;
+  mt19937_64 rng{12345};
+  shuffle(keys.begin(), keys.end(), rng);
+  queries = keys;
+  shuffle(queries.begin(), queries.end(), rng);
+}
+
+template<typename L>
+void run(const string& label, size_t n, const vector<long long>& keys,
+	 const vector<long long>& queries, long long& check){
+  L lst(n);
+  auto t0 = chrono::steady_clock::now();
+  for(long long k : keys)
+    lst.insert(k);
+  double build{seconds_since(t0)};
+  size_t mem{lst.memory_bytes()};
+  t0 = chrono::steady_clock::now();
+  for(long long k : queries)
+    check += *lst.find(k);
+  report(label, n, mem, build, seconds_since(t0));
+}
+
+int main(int argc, char* argv[])
+  try{
+    size_t n{argc>1 ? stoul(argv[1]) : 10000000};
+    string which{argc>2 ? argv[2] : "stb"};
+
+    vector<long long> keys, queries;
+    make_keys(n, keys, queries);
+    long long check{0};
+    cout << "keys: " << n << ", keys per block: " << Block_skip_list<long long>::block_cap
+	 << " (128 bytes), " << Block_skip_list<long long, 64>::block_cap << " (64 bytes)\n";
+
+    if(which.find('s') != string::npos){
+      size_t m0{rss()};
+      Skip_list<long long> head(0, true);
+      deque<Skip_list<long long>> nodes;
+      auto t0 = chrono::steady_clock::now();
+      for(long long k : keys){
+	nodes.emplace_back(k);
+	nodes.back().insert(head);
+      }
+      double build{seconds_since(t0)};
+      size_t mem{rss() - m0};
+      t0 = chrono::steady_clock::now();
+      for(long long k : queries)
+	check += head.search(head, k)->get_key();
+      report("Skip_list<long long>            ", n, mem, build, seconds_since(t0));
+    }
+    if(which.find('t') != string::npos)
+      run<Tower_skip_list<long long>>("Tower_skip_list<long long>      ", n, keys, queries,
+				      check);
+    if(which.find('b') != string::npos){
+      run<Block_skip_list<long long>>("Block_skip_list<long long>      ", n, keys, queries,
+				      check);
+      run<Block_skip_list<long long, 64>>("Block_skip_list<long long, 64>  ", n, keys,
+					  queries, check);
+      run<Block_skip_list<int>>("Block_skip_list<int> (SSE2)     ", n, keys, queries, check);
+    }
+    cout << "(checksum " << check << ")\n";
+    return 0;
+  }
+  catch(exception& e){
+    cerr << e.what() << endl;
+    return 1;
+  }
+  catch(...){
+    cerr << "Unknown error happens\n";
+    return 1;
+  }
@@ -0,0 +1,65 @@
+
+// Benchmark of building a Tower_skip_list<T> from sorted keys: insert() for each key against
+// assign_sorted() with random and deterministic heights, and with several threads.
+// After each build, all the keys are searched once, to check the list and to see the search
+// time with each way of deciding the heights.
+// usage: ./bench_bulk [number of keys] [max threads]
+
+#include "./tower_skip_list.h"
+#include<chrono>
+
+double seconds_since(chrono::steady_clock::time_point t0){
+  return chrono::duration<double>(chrono::steady_clock::now()-t0).count();
+}
+
+// search every key, and return ns per search
+double check_all(const Tower_skip_list<long long>& tsl, const vector<long long>& keys){
+  auto t0 = chrono::steady_clock::now();
+  for(long long k : keys)
+    if(tsl.find(k) == nullptr)
+      error("key not found after the build");
+  if(tsl.size() != keys.size())
+    error("wrong size after the build");
+  return seconds_since(t0)*1e9/keys.size();
+}
+
+int main(int argc, char* argv[])
+  try{
+    size_t n{argc>1 ? stoul(argv[1]) : 10000000};
+    int max_threads{argc>2 ? stoi(argv[2]) : 8};
+
+    vector<long long> keys(n);
+    for(size_t i=0; i<n; ++i)
+      keys[i] = static_cast<long long>(i)*3 + 1;
+    cout << "sorted keys: " << n << ", hardware threads: " << thread::hardware_concurrency()
+	 << endl;
+
+    {
+      Tower_skip_list<long long> tsl(n);
+      auto t0 = chrono::steady_clock::now();
+      for(long long k : keys)
+	tsl.insert(k);
+      double sec{seconds_since(t0)};
+      cout << "insert() for each key         : " << sec << " s, search "
+	   << check_all(tsl, keys) << " ns/key\n";
+    }
+    for(bool random_heights : {true, false})
+      for(int t=1; t<=max_threads; t*=2){
+	Tower_skip_list<long long> tsl(n);
+	auto t0 = chrono::steady_clock::now();
+	tsl.assign_sorted(keys.begin(), keys.end(), random_heights, t);
+	double sec{seconds_since(t0)};
+	cout << "assign_sorted(" << (random_heights? "random" : "balanced") << ", "
+	     << t << " threads) : " << sec << " s, search " << check_all(tsl, keys)
+	     << " ns/key\n";
+      }
+    return 0;
+  }
+  catch(exception& e){
+    cerr << e.what() << endl;
+    return 1;
+  }
+  catch(...){
+    cerr << "Unknown error happens\n";
+    return 1;
+  }
@@ -0,0 +1,101 @@
+
+// Benchmark of Concurrent_skip_list<T> against Tower_skip_list<T> guarded by 1 mutex.
+// The list is first filled with n random keys out of [0, 2n). Then each thread does random
+// operations on keys in [0, 2n): contains() with the given read ratio, and insert() or erase()
+// (half and half) otherwise. The total throughput is reported for 1, 2, 4, ... threads.
+// Note that threads more than the cores of the machine only take turns on the cores, so the
+// throughput can't scale beyond the number of cores (shown as "hardware threads").
+// usage: ./bench_concurrent [n] [operations per thread] [max threads] [read percent]
+
+#include "./tower_skip_list.h"
+#include "./concurrent_skip_list.h"
+#include<thread>
+#include<mutex>
+#include<chrono>
+
+// Tower_skip_list<T> with every operation serialized by a mutex
+struct Locked_skip_list {
+  Tower_skip_list<long long> tsl;
+  mutex m;
+  explicit Locked_skip_list(size_t n) : tsl(n) {}
+  bool insert(long long k){lock_guard<mutex> lck(m); return tsl.insert(k);}
+  bool erase(long long k){lock_guard<mutex> lck(m); return tsl.erase(k);}
+  bool contains(long long k){lock_guard<mutex> lck(m); return tsl.contains(k);}
+};
+
+// return million operations per second of num_threads threads
+template<typename L>
+double run(L& lst, int num_threads, size_t ops_per_thread, long long key_range, int read_percent){
+  atomic<long long> check{0};
+  vector<thread> threads;
+  auto t0 = chrono::steady_clock::now();
+  for(int t=0; t<num_threads; ++t)
+    threads.push_back(thread([&, t]{
+	  mt19937_64 rng(2024+t);
+	  uniform_int_distribution<long long> key_dist(0, key_range-1);
+	  uniform_int_distribution<int> percent(0, 99);
+	  long long c{0};
+	  for(size_t i=0; i<ops_per_thread; ++i){
+	    long long k{key_dist(rng)};
+	    int r{percent(rng)};
+	    if(r < read_percent)
+	      c += lst.contains(k);
+	    else if((r - read_percent) % 2 == 0)
+	      c += lst.insert(k);
+	    else
+	      c += lst.erase(k);
+	  }
+	  check += c;
+	}));
+  for(thread& th : threads)
+    th.join();
+  double sec{chrono::duration<double>(chrono::steady_clock::now()-t0).count()};
+  if(check.load() < 0)
+    cout << "never happens\n";	// use check, so that the loops are not optimized away
+  return num_threads*ops_per_thread / sec / 1e6;
+}
+
+template<typename L>
+void preload(L& lst, size_t n){
+  mt19937_64 rng{2024};
+  uniform_int_distribution<long long> key_dist(0, 2*static_cast<long long>(n)-1);
+  for(size_t i=0; i<n; ++i)
+    lst.insert(key_dist(rng));
+}
+
+int main(int argc, char* argv[])
+  try{
+    size_t n{argc>1 ? stoul(argv[1]) : 1000000};
+    size_t ops{argc>2 ? stoul(argv[2]) : 200000};
+    int max_threads{argc>3 ? stoi(argv[3]) : 64};
+    int read_percent{argc>4 ? stoi(argv[4]) : 80};
+
+    cout << "initial keys: " << n << ", operations per thread: " << ops
+	 << ", reads: " << read_percent << "%, hardware threads: "
+	 << thread::hardware_concurrency() << endl;
+    cout << "threads\tmutex+Tower_skip_list\tConcurrent_skip_list  (Mops/s)\n";
+    for(int t=1; t<=max_threads; t*=2){
+      // a fresh list for each number of threads, so that each run starts from the same state
+      double locked, lock_free;
+      {
+	Locked_skip_list lst(n);
+	preload(lst, n);
+	locked = run(lst, t, ops, 2*n, read_percent);
+      }
+      {
+	Concurrent_skip_list<long long> lst(n);
+	preload(lst, n);
+	lock_free = run(lst, t, ops, 2*n, read_percent);
+      }
+      cout << t << "\t" << locked << "\t\t\t" << lock_free << endl;
+    }
+    return 0;
+  }
+  catch(exception& e){
+    cerr << e.what() << endl;
+    return 1;
+  }
+  catch(...){
+    cerr << "Unknown exception is caught\n";
+    return 1;
+  }
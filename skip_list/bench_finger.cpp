@@ -0,0 +1,78 @@
+
+// Benchmark of batched lookups in Tower_skip_list<T>: find() for each key from the top of head,
+// against find_sorted(), which resumes each search from the path of the previous one (finger
+// search). Batches of m keys are drawn at random out of the keys in the list (and as many
+// keys that are not in it), and looked up
+// - sorted: the batch is sorted first (like the keys of a merge join)
+// - random: the batch is in random order, so the finger rarely helps
+// usage: ./bench_finger [number of keys in the list] [number of keys looked up per size]
+
+#include "./tower_skip_list.h"
+#include<chrono>
+#include<algorithm>		// for sort()
+
+double seconds_since(chrono::steady_clock::time_point t0){
+  return chrono::duration<double>(chrono::steady_clock::now()-t0).count();
+}
+
+int main(int argc, char* argv[])
+  try{
+    size_t n{argc>1 ? stoul(argv[1]) : 1000000};
+    size_t total{argc>2 ? stoul(argv[2]) : 2000000};
+
+    // even keys are in the list, odd keys are not
+    vector<long long> keys(n);
+    for(size_t i=0; i<n; ++i)
+      keys[i] = 2*static_cast<long long>(i);
+    Tower_skip_list<long long> tsl(n);
+    tsl.assign_sorted(keys.begin(), keys.end());
+
+    mt19937_64 rng{2024};
+    uniform_int_distribution<long long> key_dist(0, 2*static_cast<long long>(n)-1);
+    cout << "keys in the list: " << n << ", lookups per batch size: " << total << endl;
+    cout << "batch size\torder\tfind() ns/key\tfind_sorted() ns/key\n";
+    for(size_t m : {size_t(16), size_t(1000), size_t(100000), n}){
+      size_t num_batches{(total + m - 1)/m};
+      vector<vector<long long>> batches(num_batches, vector<long long>(m));
+      for(auto& b : batches)
+	for(auto& k : b)
+	  k = key_dist(rng);
+      vector<const long long*> results(m);
+
+      for(bool sorted : {true, false}){
+	if(sorted)
+	  for(auto& b : batches)
+	    sort(b.begin(), b.end());
+	long long check{0};
+	auto t0 = chrono::steady_clock::now();
+	for(const auto& b : batches)
+	  for(long long k : b)
+	    check += (tsl.find(k) != nullptr);
+	double plain{seconds_since(t0)};
+	t0 = chrono::steady_clock::now();
+	for(const auto& b : batches){
+	  tsl.find_sorted(b.begin(), b.end(), results.begin());
+	  for(const long long* p : results)
+	    check -= (p != nullptr);
+	}
+	double finger{seconds_since(t0)};
+	if(check != 0)
+	  error("find() and find_sorted() don't agree");
+	double keys_done{double(num_batches*m)};
+	cout << m << "\t\t" << (sorted? "sorted" : "random") << "\t" << plain*1e9/keys_done
+	     << "\t\t" << finger*1e9/keys_done << endl;
+	if(sorted)		// shuffle them again for the random order
+	  for(auto& b : batches)
+	    shuffle(b.begin(), b.end(), rng);
+      }
+    }
+    return 0;
+  }
+  catch(exception& e){
+    cerr << e.what() << endl;
+    return 1;
+  }
+  catch(...){
+    cerr << "Unknown error happens\n";
+    return 1;
+  }
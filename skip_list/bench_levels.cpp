@@ -0,0 +1,80 @@
+
+// Benchmark of drawing node heights: the way Skip_list<T>'s constructor used to do it
+// (a random_device per node, and a uniform_real_distribution<double> per level) against
+// Level_generator, for some values of p. The average height is also shown, which should be
+// close to 1/(1-p). Then it measures the insert throughput of Skip_list<T>, whose constructor
+// now uses Level_generator.
+// usage: ./bench_levels [number of heights] [number of keys to insert]
+
+#include "./skip_list.h"
+#include<chrono>
+#include<deque>
+#include<algorithm>		// for shuffle()
+
+const int max_height{1000};	// the same cap as Skip_list<T>
+
+// the height drawn as in the old Skip_list<T>'s constructor
+int old_height(double prob){
+  random_device rand_dev;
+  static default_random_engine generator(rand_dev());
+  uniform_real_distribution<double> distribution(0.0,1.0);
+  int height{1};
+  double rn{distribution(generator)};
+  while(rn <= prob && height <= max_height){
+    height++;
+    rn = distribution(generator);
+  }
+  return height;
+}
+
+template<typename F>
+void measure(const string& label, size_t n, F f){
+  long long sum{0};
+  auto t0 = chrono::steady_clock::now();
+  for(size_t i=0; i<n; ++i)
+    sum += f();
+  double sec{chrono::duration<double>(chrono::steady_clock::now()-t0).count()};
+  cout << "  " << label << sec*1e9/n << " ns/height, average height " << double(sum)/n << endl;
+}
+
+int main(int argc, char* argv[])
+  try{
+    size_t n{argc>1 ? stoul(argv[1]) : 10000000};
+    size_t num_keys{argc>2 ? stoul(argv[2]) : 1000000};
+
+    for(double p : {1/2.0, 1/4.0, 1/exp(1.0)}){
+      cout << "p= " << p << " (1/(1-p)= " << 1/(1-p) << ")\n";
+      // the old way is much slower, so it draws 1/10 of the heights
+      measure("random_device + uniform_real_distribution: ", n/10,
+	      [p]{return old_height(p);});
+      Level_generator levels(p, 2024);
+      measure("Level_generator                          : ", n,
+	      [&levels]{return levels(max_height);});
+    }
+
+    // insert random keys to a Skip_list<T>. The nodes are kept in a deque, as in bench_tower
+    vector<long long> keys(num_keys);
+    for(size_t i=0; i<num_keys; ++i)
+      keys[i] = static_cast<long long>(i)*7 + 1;
+    shuffle(keys.begin(), keys.end(), mt19937_64{12345});
+    Skip_list<long long>::seed(2024);
+    Skip_list<long long> head(0, true);
+    deque<Skip_list<long long>> nodes;
+    auto t0 = chrono::steady_clock::now();
+    for(size_t i=0; i<num_keys; ++i){
+      nodes.emplace_back(keys[i]);
+      nodes.back().insert(head);
+    }
+    double sec{chrono::duration<double>(chrono::steady_clock::now()-t0).count()};
+    cout << "Skip_list<long long> insert: " << sec*1e9/num_keys << " ns/key ("
+	 << num_keys/sec/1e6 << " M inserts/s) with " << num_keys << " keys\n";
+    return 0;
+  }
+  catch(exception& e){
+    cerr << e.what() << endl;
+    return 1;
+  }
+  catch(...){
+    cerr << "Unknown error happens\n";
+    return 1;
+  }
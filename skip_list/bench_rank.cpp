@@ -0,0 +1,79 @@
+
+// Benchmark of order statistics on Indexable_skip_list<T>: percentile queries (select()),
+// rank(), and count() of a range, against the linear walk on level 0 of a
+// Tower_skip_list<T>, which is how they had to be answered before.
+// usage: ./bench_rank [number of keys] [number of queries] [number of linear walks]
+
+#include "./indexable_skip_list.h"
+#include<chrono>
+
+double seconds_since(chrono::steady_clock::time_point t0){
+  return chrono::duration<double>(chrono::steady_clock::now()-t0).count();
+}
+
+int main(int argc, char* argv[])
+  try{
+    size_t n{argc>1 ? stoul(argv[1]) : 10000000};
+    size_t num_queries{argc>2 ? stoul(argv[2]) : 1000000};
+    size_t num_walks{argc>3 ? stoul(argv[3]) : 20};
+
+    // keys are inserted in ascending order, which is faster to build than a random order
+    // (but the heights are random anyway, so the shape of the list is the same)
+    Indexable_skip_list<long long> isl(n);
+    Tower_skip_list<long long> tsl(n);
+    auto t0 = chrono::steady_clock::now();
+    for(size_t i=0; i<n; ++i)
+      isl.insert(static_cast<long long>(i)*3);
+    double build{seconds_since(t0)};
+    vector<long long> keys(n);
+    for(size_t i=0; i<n; ++i)
+      keys[i] = static_cast<long long>(i)*3;
+    tsl.assign_sorted(keys.begin(), keys.end());
+    cout << "keys: " << n << ", build of Indexable_skip_list by insert(): " << build << " s\n";
+
+    mt19937_64 rng{2024};
+    uniform_real_distribution<double> percentile(0.0, 1.0);
+    uniform_int_distribution<long long> key_dist(0, 3*static_cast<long long>(n)-1);
+    long long check{0};
+
+    t0 = chrono::steady_clock::now();
+    for(size_t q=0; q<num_queries; ++q)
+      check += isl.select(static_cast<size_t>(percentile(rng)*(n-1)));
+    double sel{seconds_since(t0)};
+    t0 = chrono::steady_clock::now();
+    for(size_t q=0; q<num_queries; ++q)
+      check += isl.rank(key_dist(rng));
+    double rnk{seconds_since(t0)};
+    t0 = chrono::steady_clock::now();
+    for(size_t q=0; q<num_queries; ++q){
+      long long lo{key_dist(rng)};
+      check += isl.count(lo, lo + 3000);
+    }
+    double cnt{seconds_since(t0)};
+
+    // the i-th key by walking level 0, as Tower_skip_list<T> would do it
+    t0 = chrono::steady_clock::now();
+    for(size_t q=0; q<num_walks; ++q){
+      size_t target{static_cast<size_t>(percentile(rng)*(n-1))};
+      auto p = tsl.begin();
+      for(size_t i=0; i<target; ++i)
+	++p;
+      check += *p;
+    }
+    double walk{seconds_since(t0)};
+
+    cout << "select(percentile)   : " << sel*1e9/num_queries << " ns/query\n";
+    cout << "rank(key)            : " << rnk*1e9/num_queries << " ns/query\n";
+    cout << "count(lo, lo+3000)   : " << cnt*1e9/num_queries << " ns/query\n";
+    cout << "linear walk on level 0 (Tower_skip_list): " << walk*1e9/num_walks << " ns/query\n";
+    cout << "(checksum " << check << ")\n";
+    return 0;
+  }
+  catch(exception& e){
+    cerr << e.what() << endl;
+    return 1;
+  }
+  catch(...){
+    cerr << "Unknown error happens\n";
+    return 1;
+  }
@@ -0,0 +1,82 @@
+
+// Benchmark of SkipMap<K,V> against std::map<K,V> with mixed read/write workloads.
+// The map is first filled with n random keys out of [0, 2n), and then random operations on
+// keys in [0, 2n) are done: find() with the given read ratio, and insert() or erase() (half
+// and half) otherwise, so the size stays around n.
+// usage: ./bench_skipmap [n] [number of operations]
+
+#include "./skip_map.h"
+#include<map>
+#include<chrono>
+
+struct Op {
+  int kind;			// 0: find, 1: insert, 2: erase
+  long long key;
+};
+
+template<typename M>
+double run(M& m, const vector<long long>& preload, const vector<Op>& ops, long long& check){
+  for(long long k : preload)
+    m.insert(make_pair(k, k));
+  auto t0 = chrono::steady_clock::now();
+  for(const Op& op : ops){
+    if(op.kind == 0){
+      auto p = m.find(op.key);
+      if(p != m.end())
+	check += p->second;
+    }
+    else if(op.kind == 1)
+      m.insert(make_pair(op.key, op.key));
+    else
+      check += m.erase(op.key);
+  }
+  return chrono::duration<double>(chrono::steady_clock::now()-t0).count();
+}
+
+// SkipMap<K,V>::insert() takes a key and a value, instead of a pair
+struct SkipMap_adapter {
+  SkipMap<long long, long long> m;
+  explicit SkipMap_adapter(size_t n) : m(n) {}
+  void insert(const pair<long long, long long>& kv){m.insert(kv.first, kv.second);}
+  SkipMap<long long, long long>::iterator find(long long k){return m.find(k);}
+  SkipMap<long long, long long>::iterator end(){return m.end();}
+  size_t erase(long long k){return m.erase(k);}
+};
+
+int main(int argc, char* argv[])
+  try{
+    size_t n{argc>1 ? stoul(argv[1]) : 1000000};
+    size_t num_ops{argc>2 ? stoul(argv[2]) : 2000000};
+
+    mt19937_64 rng{2024};
+    uniform_int_distribution<long long> key_dist(0, 2*static_cast<long long>(n)-1);
+    vector<long long> preload(n);
+    for(auto& k : preload)
+      k = key_dist(rng);
+
+    cout << "initial keys: " << n << ", operations: " << num_ops << endl;
+    for(int read_percent : {95, 80, 50}){
+      vector<Op> ops(num_ops);
+      uniform_int_distribution<int> percent(0, 99);
+      for(auto& op : ops){
+	op.kind = (percent(rng) < read_percent)? 0 : 1 + percent(rng)%2;
+	op.key = key_dist(rng);
+      }
+      long long check{0};
+      SkipMap_adapter sm(n);
+      double t_skip{run(sm, preload, ops, check)};
+      map<long long, long long> stl_map;
+      double t_map{run(stl_map, preload, ops, check)};
+      cout << read_percent << "% reads: SkipMap " << num_ops/t_skip/1e6 << " Mops/s, std::map "
+	   << num_ops/t_map/1e6 << " Mops/s (checksum " << check << ")\n";
+    }
+    return 0;
+  }
+  catch(exception& e){
+    cerr << e.what() << endl;
+    return 1;
+  }
+  catch(...){
+    cerr << "Unknown error happens\n";
+    return 1;
+  }
@@ -0,0 +1,93 @@
+
+// Benchmark of skip list snapshots: save_snapshot() and load_snapshot() of a
+// Tower_skip_list<long long> in MB/s of the file, against rebuilding the list by insert()
+// of every key, and the time until the first lookups with Skip_list_snapshot<T> (mmap()).
+// usage: ./bench_snapshot [number of keys] [file name] [number of lookups]
+// The file is removed at the end.
+
+#include "./skip_list_snapshot.h"
+#include<chrono>
+#include<cstdio>		// for remove()
+
+double seconds_since(chrono::steady_clock::time_point t0){
+  return chrono::duration<double>(chrono::steady_clock::now()-t0).count();
+}
+
+int main(int argc, char* argv[])
+  try{
+    size_t n{argc>1 ? stoul(argv[1]) : 10000000};
+    string fn{argc>2 ? argv[2] : "bench_snapshot.bin"};
+    size_t num_lookups{argc>3 ? stoul(argv[3]) : 1000000};
+
+    vector<long long> keys(n);
+    for(size_t i=0; i<n; ++i)
+      keys[i] = static_cast<long long>(i)*5 + 2;
+    Tower_skip_list<long long> tsl(n);
+    tsl.assign_sorted(keys.begin(), keys.end());
+    double mb_keys{n*sizeof(long long)/1e6};
+    double mb_file{(sizeof(Snapshot_header) + n*(sizeof(long long)+1))/1e6};
+    cout << "keys: " << n << ", file: " << mb_file << " MB (" << fn << ")\n";
+
+    mt19937_64 rng{2024};
+    vector<long long> queries(num_lookups);
+    for(auto& q : queries)
+      q = keys[rng()%n];
+
+    auto t0 = chrono::steady_clock::now();
+    {
+      Tower_skip_list<long long> rebuilt(n);
+      for(long long k : keys)
+	rebuilt.insert(k);
+    }
+    double reinsert{seconds_since(t0)};
+    cout << "rebuild by insert()       : " << reinsert << " s\n";
+
+    t0 = chrono::steady_clock::now();
+    save_snapshot(tsl, fn);
+    double save{seconds_since(t0)};
+    cout << "save_snapshot()           : " << save << " s, " << mb_file/save << " MB/s\n";
+
+    {
+      Tower_skip_list<long long> loaded(n);
+      t0 = chrono::steady_clock::now();
+      load_snapshot(loaded, fn);
+      double load{seconds_since(t0)};
+      cout << "load_snapshot()           : " << load << " s, " << mb_file/load << " MB/s\n";
+      if(loaded.size() != n)
+	error("the loaded list is different from the saved one");
+      for(auto p = loaded.begin(), q = tsl.begin(); p!=loaded.end(); ++p, ++q)
+	if(*p != *q || p.height() != q.height())
+	  error("the loaded list is different from the saved one");
+    }
+
+    {
+      Tower_skip_list<long long> loaded(n);
+      save_snapshot(tsl, fn, false);	// keys only
+      t0 = chrono::steady_clock::now();
+      load_snapshot(loaded, fn);
+      double load{seconds_since(t0)};
+      cout << "load_snapshot(keys only)  : " << load << " s, " << mb_keys/load << " MB/s\n";
+    }
+
+    t0 = chrono::steady_clock::now();
+    Skip_list_snapshot<long long> snap(fn);
+    double open{seconds_since(t0)};
+    long long check{0};
+    t0 = chrono::steady_clock::now();
+    for(long long q : queries)
+      check += *snap.find(q);
+    double lookups{seconds_since(t0)};
+    cout << "Skip_list_snapshot (mmap) : open " << open*1e6 << " us, then "
+	 << lookups*1e9/num_lookups << " ns/lookup (checksum " << check << ")\n";
+
+    remove(fn.c_str());
+    return 0;
+  }
+  catch(exception& e){
+    cerr << e.what() << endl;
+    return 1;
+  }
+  catch(...){
+    cerr << "Unknown error happens\n";
+    return 1;
+  }
@@ -0,0 +1,83 @@
+
+// Benchmark of Tower_skip_list<T> against Skip_list<T>: insert and search of random keys.
+// usage: ./bench_tower [number of keys] [0 to skip Skip_list<T>]
+// e.g. ./bench_tower 1000000, ./bench_tower 100000000 0
+// (Skip_list<T> makes a random_device on each node, and its head has 1000 pointers, so with
+//  100M keys it takes a long time and a lot of memory. The 2nd argument skips it.)
+
+#include "./skip_list.h"
+#include "./tower_skip_list.h"
+#include<chrono>
+#include<deque>
+#include<algorithm>		// for shuffle()
+
+double seconds_since(chrono::steady_clock::time_point t0){
+  return chrono::duration<double>(chrono::steady_clock::now()-t0).count();
+}
+
+void report(const string& label, size_t n, double insert_s, double search_s){
+  cout << label << ": insert " << insert_s*1e9/n << " ns/key, search " << search_s*1e9/n
+       << " ns/key\n";
+}
+
+int main(int argc, char* argv[])
+  try{
+    size_t n{argc>1 ? stoul(argv[1]) : 1000000};
+    bool run_original{argc>2 ? stoi(argv[2])!=0 : true};
+
+    // distinct random keys in random order, and the same keys in another random order for
+    // the search
+    vector<long long> keys(n);
+    for(size_t i=0; i<n; ++i)
+      keys[i] = static_cast<long long>(i)*7 + 1;
+    mt19937_64 rng{12345};
+    shuffle(keys.begin(), keys.end(), rng);
+    vector<long long> queries{keys};
+    shuffle(queries.begin(), queries.end(), rng);
+
+    long long check{0};
+    cout << "keys: " << n << endl;
+
+    if(run_original){
+      Skip_list<long long> head(0, true);
+      deque<Skip_list<long long>> nodes;
+      // deque doesn't move its elements when growing. (Skip_list's move constructor takes
+      // const&&, so it cannot be used by vector)
+      auto t0 = chrono::steady_clock::now();
+      for(size_t i=0; i<n; ++i){
+	nodes.emplace_back(keys[i]);
+	nodes.back().insert(head);
+      }
+      double ins{seconds_since(t0)};
+      t0 = chrono::steady_clock::now();
+      for(size_t i=0; i<n; ++i)
+	check += head.search(head, queries[i])->get_key();
+      double sea{seconds_since(t0)};
+      report("Skip_list<long long>      ", n, ins, sea);
+    }
+
+    {
+      Tower_skip_list<long long> tsl(n);
+      auto t0 = chrono::steady_clock::now();
+      for(size_t i=0; i<n; ++i)
+	tsl.insert(keys[i]);
+      double ins{seconds_since(t0)};
+      t0 = chrono::steady_clock::now();
+      for(size_t i=0; i<n; ++i)
+	check += *tsl.find(queries[i]);
+      double sea{seconds_since(t0)};
+      report("Tower_skip_list<long long>", n, ins, sea);
+      cout << "  (max_height()= " << tsl.max_height() << ")\n";
+    }
+
+    cout << "(checksum " << check << ")\n";
+    return 0;
+  }
+  catch(exception& e){
+    cerr << e.what() << endl;
+    return 1;
+  }
+  catch(...){
+    cerr << "Unknown error happens\n";
+    return 1;
+  }
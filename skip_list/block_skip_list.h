@@ -0,0 +1,381 @@
+
+#ifndef BLOCK_SKIP_LIST_GUARD
+#define BLOCK_SKIP_LIST_GUARD 1
+
+#include "./std_lib_facilities.h"
+#include "./tower_skip_list.h"	// for Node_pool<Node>
+#include "./level_generator.h"
+#include<new>			// for placement new
+#include<type_traits>
+#include<algorithm>		// for lower_bound()
+#if defined(__SSE2__)
+#include<emmintrin.h>
+#endif
+#if defined(__SSE4_2__)
+#include<nmmintrin.h>
+#endif
+
+// A node of Block_skip_list<T,Bytes>. Instead of 1 key, it holds a sorted block of up to
+// cap keys, which fill "Bytes" bytes (1 or 2 cache lines), and starts at a cache line, so
+// searching in a block reads only those cache lines. The count, the height, and the tower
+// of forward pointers come after the block.
+// Unused slots of a block of integral keys hold the largest value of T (see
+// Block_search<T,true>).
+template<typename T, int Bytes>
+struct alignas(64) Block_node {
+  static constexpr int cap{(Bytes/int(sizeof(T)) > 2)? Bytes/int(sizeof(T)) : 2};
+
+  T keys[cap];
+  int count;			// the number of keys in use, keys[0] ... keys[count-1]
+  int height;
+  Block_node* forward[1];	// "height" pointers are allocated (see Skip_node<T>)
+
+  explicit Block_node(int h) : count{0}, height{h} {}
+
+  static size_t bytes(int h){return sizeof(Block_node) + (h-1)*sizeof(Block_node*);}
+};
+
+// Block_search<T, simd>::rank(keys, count, k) returns the number of keys < k in a block.
+// For general T, it is a binary search in keys[0] ... keys[count-1].
+template<typename T, bool simd>
+struct Block_search {
+  template<int cap>
+  static int rank(const T (&keys)[cap], int count, const T& k){
+    return static_cast<int>(lower_bound(keys, keys+count, k) - keys);
+  }
+};
+
+// For signed integers of 4 or 8 bytes, all the cap slots are compared with k without a
+// branch, and the results are counted. Unused slots hold the largest value, which is never
+// < k, so they don't need to be excluded. A block is only 1 or 2 cache lines, so comparing
+// all of it costs less than the mispredicted branches of a binary search.
+// 4-byte keys use SSE2 (4 keys per instruction), which every x86-64 CPU has. 8-byte keys
+// need SSE4.2 (_mm_cmpgt_epi64, 2 keys per instruction), so it is used only when the
+// compiler is told the CPU has it (e.g. -msse4.2 or -march=native). Otherwise, or on other
+// CPUs, a plain loop is used, which the compiler may vectorize by itself.
+template<typename T>
+struct Block_search<T, true> {
+  template<int cap>
+  static int rank(const T (&keys)[cap], int /*count*/, const T& k){
+    return rank_of(keys, k, integral_constant<size_t, sizeof(T)>{});
+  }
+
+private:
+#if defined(__SSE2__)
+  template<int cap>
+  static int rank_of(const T (&keys)[cap], const T& k, integral_constant<size_t, 4>){
+    static_assert(cap%4 == 0, "a block of 4-byte keys must be a multiple of 16 bytes");
+    __m128i kk{_mm_set1_epi32(k)};
+    int n{0};
+    for(int i=0; i<cap; i+=4){
+      __m128i v{_mm_load_si128(reinterpret_cast<const __m128i*>(keys+i))};
+      n += __builtin_popcount(_mm_movemask_ps(_mm_castsi128_ps(_mm_cmplt_epi32(v, kk))));
+    }
+    return n;
+  }
+#endif
+#if defined(__SSE4_2__)
+  template<int cap>
+  static int rank_of(const T (&keys)[cap], const T& k, integral_constant<size_t, 8>){
+    static_assert(cap%2 == 0, "a block of 8-byte keys must be a multiple of 16 bytes");
+    __m128i kk{_mm_set1_epi64x(k)};
+    int n{0};
+    for(int i=0; i<cap; i+=2){
+      __m128i v{_mm_load_si128(reinterpret_cast<const __m128i*>(keys+i))};
+      n += __builtin_popcount(_mm_movemask_pd(_mm_castsi128_pd(_mm_cmpgt_epi64(kk, v))));
+    }
+    return n;
+  }
+#endif
+  template<int cap, typename Size>
+  static int rank_of(const T (&keys)[cap], const T& k, Size){
+    int n{0};
+    for(int i=0; i<cap; ++i)
+      n += (keys[i] < k);
+    return n;
+  }
+};
+
+// A skip list of blocks of keys. In Tower_skip_list<T>, each key has its own node with at
+// least 1 pointer, plus the padding and the height, so a long long key takes 24 bytes or
+// more in a node, and each step of a search is a cache miss. Here level 0 is a list of
+// blocks of up to Block_node::cap sorted keys each, and the upper levels index the blocks
+// by their 1st key. A search goes down the levels to the block that may have the key, and
+// then searches the block in its 1 or 2 cache lines.
+// A full block is split in half on insert, and an empty block is removed on erase. Blocks
+// are not merged, so after many erases blocks can be less than half full.
+// Bytes is the size of a block in bytes, a multiple of 64 (the size of a cache line).
+template<typename T, int Bytes = 128>
+class Block_skip_list : private Skip_list_base {
+  static_assert(Bytes%64 == 0, "Bytes must be a multiple of the cache line size (64)");
+public:
+  using Node = Block_node<T, Bytes>;
+  using Skip_list_base::max_levels;
+  static constexpr int block_cap{Node::cap};
+
+  explicit Block_skip_list(size_t expected_size = 1<<20, double p = 1/2.0);
+  ~Block_skip_list();
+  Block_skip_list(const Block_skip_list&) = delete;
+  Block_skip_list& operator=(const Block_skip_list&) = delete;
+
+  bool insert(const T& k);	// false if k is already in the list
+  bool erase(const T& k);	// false if k is not in the list
+  const T* find(const T& k) const; // pointer to the key equal to k, or nullptr
+  bool contains(const T& k) const {return find(k) != nullptr;}
+
+  size_t size() const {return sz;}
+  size_t blocks() const {return num_blocks;}
+  size_t memory_bytes() const; // bytes of the blocks in use and of head
+  void seed(uint64_t s){levels.seed(s);}
+  void display() const;		// each level for debug. A block is shown as [k0 k1 ...]
+
+  // iterates over the keys in ascending order
+  class const_iterator {
+  public:
+    const_iterator(const Node* b, int i) : blk{b}, idx{i} {}
+    const_iterator& operator++(){
+      if(++idx == blk->count){
+	blk = blk->forward[0];
+	idx = 0;
+      }
+      return *this;
+    }
+    const T& operator*() const {return blk->keys[idx];}
+    const T* operator->() const {return &blk->keys[idx];}
+    bool operator==(const const_iterator& b) const {return blk==b.blk && idx==b.idx;}
+    bool operator!=(const const_iterator& b) const {return !(*this==b);}
+  private:
+    const Node* blk;
+    int idx;
+  };
+  const_iterator begin() const {return const_iterator(head->forward[0], 0);}
+  const_iterator end() const {return const_iterator(nullptr, 0);}
+
+private:
+  // SIMD search for the integral types of 4 or 8 bytes
+  using Search = Block_search<T, is_integral<T>::value && is_signed<T>::value
+			      && (sizeof(T)==4 || sizeof(T)==8)>;
+  static constexpr bool uses_sentinel{is_integral<T>::value};
+
+  // capacity of Skip_list_base counts blocks, not keys
+  int level;			// the number of levels in use
+  size_t sz;			// the number of keys
+  size_t num_blocks;
+  Node* head;			// only its tower is used. Its keys are never used
+  Node_pool<Node> pool;
+  Level_generator levels;
+
+  void raise_max_height();
+  Node* new_block(int h);
+  // fill update[i] with the last block at level i whose 1st key <= k (or head), and
+  // return update[0]
+  Node* find_update(const T& k, Node** update) const;
+  void unlink(Node* x, Node** update);
+
+  // head comes from pool too, since ::operator new() doesn't align it to a cache line
+  struct Pool_head {
+    Node_pool<Node>& pool;
+    void* operator()(int h) const {return pool.allocate(h);}
+    void operator()(Node* p, int h) const {pool.deallocate(p, h);}
+  };
+};
+
+template<typename T, int Bytes>
+Block_skip_list<T,Bytes>::Block_skip_list(size_t expected_size, double p)
+  // the skip list is over the blocks, which are about 3/4 full on average
+  : Skip_list_base{expected_size / (block_cap*3/4) + 1, p, "a Block_skip_list"}, level{1},
+    sz{0}, num_blocks{0}, head{nullptr}
+{
+  levels.set_probability(prob);
+  head = new_head(&Node::forward, nullptr, Pool_head{pool});
+}
+
+template<typename T, int Bytes>
+Block_skip_list<T,Bytes>::~Block_skip_list(){
+  Node* p{head->forward[0]};
+  while(p != nullptr){
+    Node* p2{p->forward[0]};
+    p->~Node();
+    p = p2;
+  }
+  // the memory of the blocks and head is freed by pool's destructor
+}
+
+template<typename T, int Bytes>
+void Block_skip_list<T,Bytes>::raise_max_height(){
+  grow_head(head, &Node::forward, nullptr, Pool_head{pool}, Pool_head{pool});
+}
+
+template<typename T, int Bytes>
+typename Block_skip_list<T,Bytes>::Node* Block_skip_list<T,Bytes>::new_block(int h){
+  Node* b{new(pool.allocate(h)) Node(h)};
+  if(uses_sentinel)
+    for(int i=0; i<block_cap; ++i)
+      b->keys[i] = numeric_limits<T>::max();
+  ++num_blocks;
+  return b;
+}
+
+template<typename T, int Bytes>
+typename Block_skip_list<T,Bytes>::Node* Block_skip_list<T,Bytes>::find_update(const T& k,
+									       Node** update) const {
+  Node* p{head};
+  for(int i=level-1; i>-1; --i){
+    while(p->forward[i]!=nullptr && !(k < p->forward[i]->keys[0]))
+      p = p->forward[i];
+    update[i] = p;
+  }
+  return p;
+}
+
+template<typename T, int Bytes>
+bool Block_skip_list<T,Bytes>::insert(const T& k){
+  if(num_blocks >= capacity)
+    raise_max_height();
+
+  Node* update[max_levels];
+  Node* x{find_update(k, update)};
+  if(x == head){
+    // k is smaller than every key, so it goes to the 1st block, whose 1st key becomes k.
+    // It is still smaller than the 1st key of the next block, so no link changes
+    x = head->forward[0];
+    if(x == nullptr){		// the 1st key of the list
+      int h{levels(max_h)};
+      if(h > level)
+	level = h;
+      x = new_block(h);
+      for(int i=0; i<h; ++i){
+	x->forward[i] = nullptr;
+	head->forward[i] = x;
+      }
+      x->keys[0] = k;
+      x->count = 1;
+      ++sz;
+      return true;
+    }
+  }
+
+  int pos{Search::rank(x->keys, x->count, k)};
+  if(pos < x->count && !(k < x->keys[pos]))
+    return false;
+
+  if(x->count == block_cap){
+    // split x in half. The new block y goes right after x at each level of y, so its
+    // predecessor at level i is update[i], or x itself if x is in that level
+    int h{levels(max_h)};
+    if(h > level){
+      for(int i=level; i<h; ++i)
+	update[i] = head;
+      level = h;
+    }
+    Node* y{new_block(h)};
+    int half{block_cap/2};
+    for(int i=half; i<block_cap; ++i){
+      y->keys[i-half] = x->keys[i];
+      if(uses_sentinel)
+	x->keys[i] = numeric_limits<T>::max();
+    }
+    y->count = block_cap - half;
+    x->count = half;
+    for(int i=0; i<h; ++i){
+      Node* pred{(update[i]->forward[i] == x || update[i] == x)? x : update[i]};
+      y->forward[i] = pred->forward[i];
+      pred->forward[i] = y;
+    }
+    if(pos > half){
+      x = y;
+      pos -= half;
+    }
+  }
+
+  // shift the keys >= k by 1
+  for(int i=x->count; i>pos; --i)
+    x->keys[i] = x->keys[i-1];
+  x->keys[pos] = k;
+  ++x->count;
+  ++sz;
+  return true;
+}
+
+template<typename T, int Bytes>
+void Block_skip_list<T,Bytes>::unlink(Node* x, Node** update){
+  for(int i=0; i<x->height; ++i)
+    update[i]->forward[i] = x->forward[i];
+  while(level > 1 && head->forward[level-1] == nullptr)
+    --level;
+  int h{x->height};
+  x->~Node();
+  pool.deallocate(x, h);
+  --num_blocks;
+}
+
+template<typename T, int Bytes>
+bool Block_skip_list<T,Bytes>::erase(const T& k){
+  Node* update[max_levels];
+  Node* x{find_update(k, update)};
+  if(x == head)
+    return false;
+  int pos{Search::rank(x->keys, x->count, k)};
+  if(pos == x->count || k < x->keys[pos])
+    return false;
+
+  if(x->count == 1){
+    // x becomes empty, so it is removed. update[i] is x itself at x's levels, so the
+    // predecessors are searched again, by < instead of <=
+    Node* p{head};
+    for(int i=level-1; i>-1; --i){
+      while(p->forward[i]!=nullptr && p->forward[i]->keys[0] < k)
+	p = p->forward[i];
+      update[i] = p;
+    }
+    unlink(x, update);
+  }
+  else{
+    for(int i=pos; i<x->count-1; ++i)
+      x->keys[i] = x->keys[i+1];
+    --x->count;
+    if(uses_sentinel)
+      x->keys[x->count] = numeric_limits<T>::max();
+  }
+  --sz;
+  return true;
+}
+
+template<typename T, int Bytes>
+const T* Block_skip_list<T,Bytes>::find(const T& k) const {
+  const Node* p{head};
+  for(int i=level-1; i>-1; --i){
+    while(p->forward[i]!=nullptr && !(k < p->forward[i]->keys[0]))
+      p = p->forward[i];
+  }
+  if(p == head)
+    return nullptr;
+  int pos{Search::rank(p->keys, p->count, k)};
+  if(pos == p->count || k < p->keys[pos])
+    return nullptr;
+  return &p->keys[pos];
+}
+
+template<typename T, int Bytes>
+size_t Block_skip_list<T,Bytes>::memory_bytes() const {
+  size_t b{Node::bytes(max_h)};
+  for(const Node* p{head->forward[0]}; p!=nullptr; p=p->forward[0])
+    b += Node_pool<Node>::block_bytes(p->height);
+  return b;
+}
+
+template<typename T, int Bytes>
+void Block_skip_list<T,Bytes>::display() const {
+  for(int i=0; i<level; ++i){
+    cout << "level " << i << ": head -> ";
+    for(const Node* p{head->forward[i]}; p!=nullptr; p=p->forward[i]){
+      cout << "[";
+      for(int j=0; j<p->count; ++j)
+	cout << p->keys[j] << ((j+1<p->count)? " " : "");
+      cout << "] -> ";
+    }
+    cout << "null\n";
+  }
+}
+
+#endif // BLOCK_SKIP_LIST_GUARD
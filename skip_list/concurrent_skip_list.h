@@ -0,0 +1,365 @@
+
+#ifndef CONCURRENT_SKIP_LIST_GUARD
+#define CONCURRENT_SKIP_LIST_GUARD 1
+
+#include "./std_lib_facilities.h"
+#include "./level_generator.h"
+#include "./tower_skip_list.h"	// for Skip_list_base
+#include<atomic>
+#include<cstdint>		// for uintptr_t
+#include<new>			// for placement new
+
+// Epoch-based reclamation for lock-free data structures.
+// A node unlinked from a lock-free structure cannot be deleted right away, because another
+// thread may still be reading it. So each thread announces the global epoch when it starts an
+// operation (enter()) and that it is done (exit()), and an unlinked node is retired with the
+// epoch of the time. The global epoch advances only when every active thread has seen it, so
+// once it has advanced twice after a node was retired, no thread can hold the node anymore,
+// and it is deleted.
+// Each thread uses one slot of records[] (taken on its 1st use, and given back when it ends),
+// so at most max_threads threads can use the structures at the same time.
+class Epoch_manager {
+public:
+  static constexpr int max_threads{256};
+
+  Epoch_manager() : global_epoch{2} {}
+  ~Epoch_manager(){
+    // no thread is in an operation anymore, so everything retired can be deleted
+    for(Record& r : records)
+      for(Retired& x : r.retired)
+	x.deleter(x.p);
+  }
+  Epoch_manager(const Epoch_manager&) = delete;
+  Epoch_manager& operator=(const Epoch_manager&) = delete;
+
+  void enter(){
+    Record& r{records[slot()]};
+    r.epoch.store(global_epoch.load());
+    r.active.store(true);
+    atomic_thread_fence(memory_order_seq_cst);
+    // the fence makes this thread's announcement visible before it reads any node
+  }
+  void exit(){records[slot()].active.store(false);}
+
+  // delete p by deleter(p) after every thread that may see p has finished its operation
+  void retire(void* p, void (*deleter)(void*)){
+    Record& r{records[slot()]};
+    r.retired.push_back(Retired{p, deleter, global_epoch.load()});
+    if(r.retired.size() >= 64){	// try to reclaim once in a while, not on every retire
+      try_advance();
+      reclaim(r);
+    }
+  }
+
+private:
+  struct Retired {
+    void* p;
+    void (*deleter)(void*);
+    uint64_t epoch;		// the global epoch when p was retired
+  };
+  struct Record {
+    atomic<uint64_t> epoch{0};	// the global epoch this thread saw in enter()
+    atomic<bool> active{false};	// true while this thread is in an operation
+    vector<Retired> retired;	// only the thread of this slot touches it
+    char pad[64];		// keep records of different threads in different cache lines
+  };
+
+  atomic<uint64_t> global_epoch;
+  Record records[max_threads];
+
+  void try_advance(){
+    uint64_t e{global_epoch.load()};
+    for(Record& r : records)
+      if(r.active.load() && r.epoch.load() != e)
+	return;			// some thread is still in an older epoch
+    global_epoch.compare_exchange_strong(e, e+1);
+  }
+  void reclaim(Record& r){
+    uint64_t e{global_epoch.load()};
+    size_t kept{0};
+    for(Retired& x : r.retired){
+      if(x.epoch + 2 <= e)
+	x.deleter(x.p);
+      else
+	r.retired[kept++] = x;
+    }
+    r.retired.resize(kept);
+  }
+
+  // the slot of the calling thread. The slots are shared by all Epoch_managers
+  static int slot(){
+    struct Slot {
+      int id;
+      Slot() : id{-1} {
+	for(int i=0; i<max_threads; ++i){
+	  bool expected{false};
+	  if(used()[i].compare_exchange_strong(expected, true)){
+	    id = i;
+	    return;
+	  }
+	}
+	error("Error in Epoch_manager. Too many threads use it at the same time.");
+      }
+      ~Slot(){used()[id].store(false);} // give the slot back when the thread ends
+    };
+    thread_local Slot s;
+    return s.id;
+  }
+  static atomic<bool>* used(){
+    static atomic<bool> u[max_threads] = {};
+    return u;
+  }
+};
+
+// RAII for Epoch_manager::enter()/exit(), like File_handle for fopen()/fclose()
+struct Epoch_guard {
+  explicit Epoch_guard(Epoch_manager& e) : em{e} {em.enter();}
+  ~Epoch_guard(){em.exit();}
+  Epoch_manager& em;
+};
+
+// A node of Concurrent_skip_list<T>. The tower is co-allocated as in Skip_node<T>, but each
+// forward pointer is atomic, and its lowest bit is used as the "deleted" mark of this node at
+// that level (nodes are aligned, so the lowest bit of a real pointer is always 0).
+template<typename T>
+struct Concurrent_node {
+  T key;
+  int height;
+  atomic<int> owners;
+  // 2 at first: the inserting thread, and a thread that erases it later. The one that
+  // finishes last retires the node (see Concurrent_skip_list<T>::release())
+  atomic<uintptr_t> next[1];	// "height" atomic pointers are allocated
+
+  static size_t bytes(int h){return sizeof(Concurrent_node) + (h-1)*sizeof(atomic<uintptr_t>);}
+};
+
+// A lock-free skip list (a set of keys), in the style of Fraser's and Herlihy & Shavit's.
+// - insert() links a new node at level 0 by compare-and-swap (CAS). That is the moment the key
+//   is in the set. Then the upper levels are linked one by one.
+// - erase() marks the forward pointers of the node from the top level down to level 0. The
+//   thread that marks level 0 is the one that erased the key. Marked nodes are physically
+//   unlinked by find(), by any thread that passes them, and deleted through Epoch_manager.
+// - contains() never writes and never retries, so it is wait-free: it just skips marked nodes.
+// The maximum height is fixed at construction, from the expected size (log_{1/p} n), because
+// the head cannot be re-allocated while other threads are reading it.
+template<typename T>
+class Concurrent_skip_list : private Skip_list_base {
+public:
+  using Node = Concurrent_node<T>;
+  using Skip_list_base::max_levels;
+
+  explicit Concurrent_skip_list(size_t expected_size = 1<<20, double p = 1/2.0);
+  ~Concurrent_skip_list();
+  Concurrent_skip_list(const Concurrent_skip_list&) = delete;
+  Concurrent_skip_list& operator=(const Concurrent_skip_list&) = delete;
+
+  bool insert(const T& k);	// false if k is already in the list
+  bool erase(const T& k);	// false if k is not in the list
+  bool contains(const T& k);	// wait-free
+
+  size_t size() const {return sz.load();}
+  // only exact when no other thread is changing the list
+
+private:
+  // max_h of Skip_list_base never changes, so its capacity is not used
+  Node* head;			// only its tower is used
+  atomic<size_t> sz;
+  Epoch_manager epochs;
+
+  static bool is_marked(uintptr_t w){return w & 1;}
+  static Node* to_node(uintptr_t w){return reinterpret_cast<Node*>(w & ~uintptr_t(1));}
+  static uintptr_t to_word(Node* p){return reinterpret_cast<uintptr_t>(p);}
+
+  int random_height();
+  Node* make_node(const T& k, int h);
+  static void delete_node(void* p);
+  void release(Node* n);
+  bool find(const T& k, Node** preds, Node** succs);
+};
+
+template<typename T>
+Concurrent_skip_list<T>::Concurrent_skip_list(size_t expected_size, double p)
+  : Skip_list_base{expected_size, p, "a Concurrent_skip_list"}, head{nullptr}, sz{0}
+{
+  head = static_cast<Node*>(::operator new(Node::bytes(max_h)));
+  for(int i=0; i<max_h; ++i)
+    new(&head->next[i]) atomic<uintptr_t>(0);
+}
+
+template<typename T>
+Concurrent_skip_list<T>::~Concurrent_skip_list(){
+  // The nodes still at level 0 are deleted here. Nodes already unlinked were retired, and
+  // are deleted by the destructor of epochs.
+  Node* p{to_node(head->next[0].load())};
+  while(p != nullptr){
+    Node* p2{to_node(p->next[0].load())};
+    delete_node(p);
+    p = p2;
+  }
+  ::operator delete(head);
+}
+
+template<typename T>
+int Concurrent_skip_list<T>::random_height(){
+  // 1 generator per thread, seeded once when the thread first comes here
+  thread_local Level_generator generator;
+  generator.set_probability(prob);
+  return generator(max_h);
+}
+
+template<typename T>
+typename Concurrent_skip_list<T>::Node* Concurrent_skip_list<T>::make_node(const T& k, int h){
+  Node* n{static_cast<Node*>(::operator new(Node::bytes(h)))};
+  new(&n->key) T(k);
+  n->height = h;
+  new(&n->owners) atomic<int>(2);
+  for(int i=0; i<h; ++i)
+    new(&n->next[i]) atomic<uintptr_t>(0);
+  return n;
+}
+
+template<typename T>
+void Concurrent_skip_list<T>::delete_node(void* p){
+  Node* n{static_cast<Node*>(p)};
+  n->key.~T();
+  ::operator delete(n);
+}
+
+template<typename T>
+void Concurrent_skip_list<T>::release(Node* n){
+  // The inserting thread may still be linking the upper levels of n after another thread
+  // erased n, so n is retired only after both of them are done with it
+  if(n->owners.fetch_sub(1) == 1)
+    epochs.retire(n, &Concurrent_skip_list<T>::delete_node);
+}
+
+// Fill preds[i]/succs[i] with the last node whose key < k and the next node at level i,
+// unlinking (snipping) every marked node found on the way. Return true if k is at level 0.
+template<typename T>
+bool Concurrent_skip_list<T>::find(const T& k, Node** preds, Node** succs){
+ retry:
+  Node* pred{head};
+  for(int i=max_h-1; i>-1; --i){
+    Node* curr{to_node(pred->next[i].load())};
+    while(curr != nullptr){
+      uintptr_t succ{curr->next[i].load()};
+      if(is_marked(succ)){
+	// curr is erased. Unlink it at this level. If pred->next[i] changed (or pred itself
+	// was marked), start over from head
+	uintptr_t expected{to_word(curr)};
+	if(!pred->next[i].compare_exchange_strong(expected, succ & ~uintptr_t(1)))
+	  goto retry;
+	curr = to_node(succ);
+	continue;
+      }
+      if(!(curr->key < k))
+	break;
+      pred = curr;
+      curr = to_node(succ);
+    }
+    preds[i] = pred;
+    succs[i] = curr;
+  }
+  return succs[0] != nullptr && !(k < succs[0]->key);
+}
+
+template<typename T>
+bool Concurrent_skip_list<T>::insert(const T& k){
+  Epoch_guard guard(epochs);
+  Node* preds[max_levels];
+  Node* succs[max_levels];
+  int h{random_height()};
+  Node* n{nullptr};
+
+  while(true){
+    if(find(k, preds, succs)){
+      if(n != nullptr)
+	delete_node(n);		// never published, so no other thread has seen it
+      return false;
+    }
+    if(n == nullptr)
+      n = make_node(k, h);
+    for(int i=0; i<h; ++i)
+      n->next[i].store(to_word(succs[i]));
+    uintptr_t expected{to_word(succs[0])};
+    if(preds[0]->next[0].compare_exchange_strong(expected, to_word(n)))
+      break;			// now k is in the set
+  }
+  ++sz;
+
+  // link the upper levels
+  for(int i=1; i<h; ++i){
+    while(true){
+      uintptr_t old{n->next[i].load()};
+      if(is_marked(old))
+	goto linked;		// n is being erased. Don't link it any higher
+      if(to_node(old) != succs[i] && !n->next[i].compare_exchange_strong(old, to_word(succs[i])))
+	continue;		// n->next[i] was marked just now. See it again
+      uintptr_t expected{to_word(succs[i])};
+      if(preds[i]->next[i].compare_exchange_strong(expected, to_word(n)))
+	break;
+      find(k, preds, succs);	// preds[i] or succs[i] changed. Search again
+    }
+  }
+ linked:
+  // If n was erased while linking, some levels may have been linked after the eraser
+  // unlinked n, so unlink them again
+  if(is_marked(n->next[0].load()))
+    find(k, preds, succs);
+  release(n);
+  return true;
+}
+
+template<typename T>
+bool Concurrent_skip_list<T>::erase(const T& k){
+  Epoch_guard guard(epochs);
+  Node* preds[max_levels];
+  Node* succs[max_levels];
+  if(!find(k, preds, succs))
+    return false;
+  Node* victim{succs[0]};
+
+  // mark the upper levels from the top. These marks just stop others from linking after
+  // victim at these levels
+  for(int i=victim->height-1; i>0; --i){
+    uintptr_t s{victim->next[i].load()};
+    while(!is_marked(s) && !victim->next[i].compare_exchange_weak(s, s | 1)){}
+  }
+  // the thread that marks level 0 is the one that erases k
+  uintptr_t s{victim->next[0].load()};
+  while(true){
+    if(is_marked(s))
+      return false;		// another thread erased it first
+    if(victim->next[0].compare_exchange_strong(s, s | 1))
+      break;
+  }
+  --sz;
+  find(k, preds, succs);	// unlink victim at every level
+  release(victim);
+  return true;
+}
+
+template<typename T>
+bool Concurrent_skip_list<T>::contains(const T& k){
+  Epoch_guard guard(epochs);
+  Node* pred{head};
+  Node* curr{nullptr};
+  for(int i=max_h-1; i>-1; --i){
+    curr = to_node(pred->next[i].load());
+    while(curr != nullptr){
+      uintptr_t succ{curr->next[i].load()};
+      if(is_marked(succ)){	// skip it, without unlinking
+	curr = to_node(succ);
+	continue;
+      }
+      if(!(curr->key < k))
+	break;
+      pred = curr;
+      curr = to_node(succ);
+    }
+  }
+  // curr is the 1st unmarked node with key >= k at level 0
+  return curr != nullptr && !(k < curr->key);
+}
+
+#endif // CONCURRENT_SKIP_LIST_GUARD
@@ -0,0 +1,279 @@
+
+#ifndef INDEXABLE_SKIP_LIST_GUARD
+#define INDEXABLE_SKIP_LIST_GUARD 1
+
+#include "./std_lib_facilities.h"
+#include "./tower_skip_list.h"	// for Node_pool<Node>
+#include "./level_generator.h"
+#include<new>			// for placement new
+
+// A node of Indexable_skip_list<T>. The same layout as Skip_node<T>, but each forward
+// pointer has a "span": the number of level-0 steps it jumps over. E.g. if a node at level 2
+// points to the node 5 keys ahead, the span of that link is 5.
+template<typename T>
+struct Indexed_node {
+  struct Link {
+    Indexed_node* next;
+    size_t span;
+  };
+
+  T key;
+  int height;
+  Link link[1];			// "height" links are allocated (see Skip_node<T>)
+
+  Indexed_node(const T& k, int h) : key{k}, height{h} {}
+
+  static size_t bytes(int h){return sizeof(Indexed_node) + (h-1)*sizeof(Link);}
+};
+
+// A skip list with order statistics, like the skip list of the sorted sets (zset) of Redis.
+// Number the keys 1, 2, ..., size() in ascending order, and head 0. Then the span of a link
+// is the difference of the numbers of the 2 nodes (a null link points to size()). Summing
+// the spans along a search path gives the position of a key, so in O(log n) (expected)
+// - rank(k): the number of keys < k, which is the 0-based index of k if k is in the list,
+// - select(i): the key with 0-based index i, e.g. select(size()/2) is the median,
+// - erase_at(i): erase the key with 0-based index i,
+// - count(lo, hi): the number of keys in [lo, hi).
+// Without spans, all of these are linear walks on level 0.
+// Otherwise it works like Tower_skip_list<T> (own nodes from a Node_pool, no duplicate keys,
+// and the maximum height follows the size).
+template<typename T>
+class Indexable_skip_list : private Skip_list_base {
+public:
+  using Node = Indexed_node<T>;
+  using Skip_list_base::max_levels;
+
+  explicit Indexable_skip_list(size_t expected_size = 1<<20, double p = 1/2.0);
+  ~Indexable_skip_list();
+  Indexable_skip_list(const Indexable_skip_list&) = delete;
+  Indexable_skip_list& operator=(const Indexable_skip_list&) = delete;
+
+  bool insert(const T& k);	// false if k is already in the list
+  bool erase(const T& k);	// false if k is not in the list
+  T erase_at(size_t i);		// erase the i-th key (0-based), and return it
+  const T* find(const T& k) const; // pointer to the key equal to k, or nullptr
+  bool contains(const T& k) const {return find(k) != nullptr;}
+
+  size_t rank(const T& k) const; // the number of keys < k
+  const T& select(size_t i) const; // the i-th smallest key (0-based)
+  size_t count(const T& lo, const T& hi) const; // the number of keys in [lo, hi)
+
+  size_t size() const {return sz;}
+  void seed(uint64_t s){levels.seed(s);}
+  void display() const;		// each level with the spans, for debug
+
+  class const_iterator {
+  public:
+    explicit const_iterator(const Node* p) : curr{p} {}
+    const_iterator& operator++(){curr = curr->link[0].next; return *this;}
+    const T& operator*() const {return curr->key;}
+    const T* operator->() const {return &curr->key;}
+    bool operator==(const const_iterator& b) const {return curr==b.curr;}
+    bool operator!=(const const_iterator& b) const {return curr!=b.curr;}
+  private:
+    const Node* curr;
+  };
+  const_iterator begin() const {return const_iterator(head->link[0].next);}
+  const_iterator end() const {return const_iterator(nullptr);}
+
+private:
+  int level;			// the number of levels in use
+  size_t sz;
+  Node* head;			// only its links are used. Its key is never constructed
+  Node_pool<Node> pool;
+  Level_generator levels;
+
+  void raise_max_height();
+  void unlink(Node* x, Node** update); // remove x, with update[] filled as in erase()
+};
+
+template<typename T>
+Indexable_skip_list<T>::Indexable_skip_list(size_t expected_size, double p)
+  : Skip_list_base{expected_size, p, "an Indexable_skip_list"}, level{1}, sz{0}, head{nullptr}
+{
+  levels.set_probability(prob);
+  head = new_head(&Node::link, typename Node::Link{nullptr, 0}, Heap_head<Node>{});
+}
+
+template<typename T>
+Indexable_skip_list<T>::~Indexable_skip_list(){
+  Node* p{head->link[0].next};
+  while(p != nullptr){
+    Node* p2{p->link[0].next};
+    p->~Node();
+    p = p2;
+  }
+  ::operator delete(head);
+}
+
+template<typename T>
+void Indexable_skip_list<T>::raise_max_height(){
+  // the new top link of head spans all the keys
+  grow_head(head, &Node::link, typename Node::Link{nullptr, sz}, Heap_head<Node>{},
+	    Heap_head<Node>{});
+}
+
+template<typename T>
+bool Indexable_skip_list<T>::insert(const T& k){
+  if(sz >= capacity)
+    raise_max_height();
+
+  Node* update[max_levels];
+  size_t pos[max_levels];	// pos[i] is the position of update[i]
+  Node* p{head};
+  for(int i=level-1; i>-1; --i){
+    pos[i] = (i == level-1)? 0 : pos[i+1];
+    while(p->link[i].next!=nullptr && p->link[i].next->key < k){
+      pos[i] += p->link[i].span;
+      p = p->link[i].next;
+    }
+    update[i] = p;
+  }
+  if(p->link[0].next != nullptr && !(k < p->link[0].next->key))
+    return false;
+
+  int h{levels(max_h)};
+  if(h > level){
+    for(int i=level; i<h; ++i){
+      update[i] = head;
+      pos[i] = 0;
+      head->link[i] = {nullptr, sz}; // a null link points to size()
+    }
+    level = h;
+  }
+
+  // the new node is at position pos[0]+1. A link of update[i] that jumps over it is cut in
+  // 2 at the new node. A link above its height just gets 1 longer
+  Node* n{new(pool.allocate(h)) Node(k, h)};
+  for(int i=0; i<h; ++i){
+    n->link[i].next = update[i]->link[i].next;
+    n->link[i].span = update[i]->link[i].span - (pos[0] - pos[i]);
+    update[i]->link[i].next = n;
+    update[i]->link[i].span = pos[0] - pos[i] + 1;
+  }
+  for(int i=h; i<level; ++i)
+    ++update[i]->link[i].span;
+  ++sz;
+  return true;
+}
+
+template<typename T>
+void Indexable_skip_list<T>::unlink(Node* x, Node** update){
+  for(int i=0; i<level; ++i){
+    if(update[i]->link[i].next == x){
+      update[i]->link[i].span += x->link[i].span - 1;
+      update[i]->link[i].next = x->link[i].next;
+    }
+    else
+      --update[i]->link[i].span;
+  }
+  while(level > 1 && head->link[level-1].next == nullptr)
+    --level;
+  int h{x->height};
+  x->~Node();
+  pool.deallocate(x, h);
+  --sz;
+}
+
+template<typename T>
+bool Indexable_skip_list<T>::erase(const T& k){
+  Node* update[max_levels];
+  Node* p{head};
+  for(int i=level-1; i>-1; --i){
+    while(p->link[i].next!=nullptr && p->link[i].next->key < k)
+      p = p->link[i].next;
+    update[i] = p;
+  }
+  p = p->link[0].next;
+  if(p == nullptr || k < p->key)
+    return false;
+  unlink(p, update);
+  return true;
+}
+
+template<typename T>
+T Indexable_skip_list<T>::erase_at(size_t i){
+  if(i >= sz)
+    error("Error in Indexable_skip_list::erase_at(). The index is out of range.");
+  // the same as erase(), but moving forward while the position is < i+1 instead of the key
+  Node* update[max_levels];
+  Node* p{head};
+  size_t pos{0};
+  for(int l=level-1; l>-1; --l){
+    while(p->link[l].next!=nullptr && pos + p->link[l].span < i+1){
+      pos += p->link[l].span;
+      p = p->link[l].next;
+    }
+    update[l] = p;
+  }
+  Node* x{p->link[0].next};
+  T k{x->key};
+  unlink(x, update);
+  return k;
+}
+
+template<typename T>
+const T* Indexable_skip_list<T>::find(const T& k) const {
+  const Node* p{head};
+  for(int i=level-1; i>-1; --i){
+    while(p->link[i].next!=nullptr && p->link[i].next->key < k)
+      p = p->link[i].next;
+  }
+  p = p->link[0].next;
+  if(p == nullptr || k < p->key)
+    return nullptr;
+  return &p->key;
+}
+
+template<typename T>
+size_t Indexable_skip_list<T>::rank(const T& k) const {
+  // the position of the last node with key < k, which is the number of such keys
+  const Node* p{head};
+  size_t pos{0};
+  for(int i=level-1; i>-1; --i){
+    while(p->link[i].next!=nullptr && p->link[i].next->key < k){
+      pos += p->link[i].span;
+      p = p->link[i].next;
+    }
+  }
+  return pos;
+}
+
+template<typename T>
+const T& Indexable_skip_list<T>::select(size_t i) const {
+  if(i >= sz)
+    error("Error in Indexable_skip_list::select(). The index is out of range.");
+  const Node* p{head};
+  size_t pos{0};
+  for(int l=level-1; l>-1; --l){
+    while(p->link[l].next!=nullptr && pos + p->link[l].span <= i+1){
+      pos += p->link[l].span;
+      p = p->link[l].next;
+    }
+    if(pos == i+1)
+      break;			// no need to go down to level 0
+  }
+  return p->key;
+}
+
+template<typename T>
+size_t Indexable_skip_list<T>::count(const T& lo, const T& hi) const {
+  if(!(lo < hi))
+    return 0;
+  return rank(hi) - rank(lo);
+}
+
+template<typename T>
+void Indexable_skip_list<T>::display() const {
+  for(int i=0; i<level; ++i){
+    cout << "level " << i << ": head -" << head->link[i].span << "-> ";
+    const Node* p{head->link[i].next};
+    while(p!=nullptr){
+      cout << p->key << " -" << p->link[i].span << "-> ";
+      p = p->link[i].next;
+    }
+    cout << "null\n";
+  }
+}
+
+#endif // INDEXABLE_SKIP_LIST_GUARD
@@ -0,0 +1,93 @@
+
+#ifndef LEVEL_GENERATOR_GUARD
+#define LEVEL_GENERATOR_GUARD 1
+
+#include "./std_lib_facilities.h"
+#include<cstdint>		// for uint64_t
+
+// Level_generator draws the height of a new skip list node: 1 + the number of successive
+// "heads" of a coin whose heads come up with probability p, capped by a maximum height.
+// Drawing it by uniform_real_distribution<double> takes 1 random number per level, and
+// Skip_list<T>'s constructor made a random_device (which reads /dev/urandom, a system call
+// on Linux) for every node. Here 1 64-bit random number gives the whole height:
+// - p == 1/2: each bit of the random number is a fair coin, so the height is 1 + the number
+//   of trailing 0 bits (count trailing zeros, 1 instruction on x86 and ARM).
+// - p == 1/2^k: k bits make 1 coin with heads probability 1/2^k, so the height is
+//   1 + (the number of trailing 0 bits)/k.
+// - other p: compare a random number with p*2^64 per level, with no conversion to double.
+// The random numbers come from xorshift64*, which is a few instructions per number and has
+// 8 bytes of state, so a generator can be kept per list or per thread. It is not good enough
+// for cryptography, but more than enough for coin flips.
+// With the same seed, the same sequence of heights is drawn, so runs are reproducible.
+class Level_generator {
+public:
+  explicit Level_generator(double p = 1/2.0, uint64_t s = random_seed())
+    : prob{-1}, shift{0}, threshold{0}, state{1}
+  {
+    set_probability(p);
+    seed(s);
+  }
+
+  // the height of a new node, in [1, max_h]
+  int operator()(int max_h){
+    if(shift > 0){
+      uint64_t r{next()};
+      int zeros{(r == 0)? 64 : __builtin_ctzll(r)};
+      int h{1 + zeros/shift};
+      return (h < max_h)? h : max_h;
+    }
+    if(prob >= 1)
+      return max_h;
+    int h{1};
+    while(h < max_h && next() < threshold)
+      ++h;
+    return h;
+  }
+
+  void seed(uint64_t s){
+    // xorshift needs a state other than 0. Mixing the seed by splitmix64 also makes
+    // close seeds (1, 2, 3, ...) give unrelated sequences
+    s += 0x9E3779B97F4A7C15ULL;
+    s = (s ^ (s >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    s = (s ^ (s >> 27)) * 0x94D049BB133111EBULL;
+    s ^= s >> 31;
+    state = (s == 0)? 1 : s;
+  }
+
+  void set_probability(double p){
+    if(p<0 || p>1)
+      error("Error in Level_generator. The probability must be in [0,1].");
+    if(p == prob)
+      return;
+    prob = p;
+    shift = 0;
+    // p == 1/2^k for an integer k (1 <= k <= 63)?
+    int e;
+    if(p > 0 && frexp(p, &e) == 0.5 && e <= 0 && e > -63)
+      shift = 1 - e;
+    // p*2^64 without overflow. With p == 1, operator() doesn't use it
+    threshold = (p >= 1)? ~uint64_t(0) : static_cast<uint64_t>(ldexp(p, 64));
+  }
+  double probability() const {return prob;}
+
+  // a seed from random_device. It is called only when a generator is made without a seed
+  static uint64_t random_seed(){
+    random_device rd;
+    return (static_cast<uint64_t>(rd()) << 32) ^ rd();
+  }
+
+private:
+  double prob;
+  int shift;			// k if prob == 1/2^k, otherwise 0
+  uint64_t threshold;		// prob*2^64. A random number < threshold is a "heads"
+  uint64_t state;
+
+  uint64_t next(){		// xorshift64*
+    state ^= state >> 12;
+    state ^= state << 25;
+    state ^= state >> 27;
+    return state * 0x2545F4914F6CDD1DULL;
+  }
+};
+
+#endif // LEVEL_GENERATOR_GUARD
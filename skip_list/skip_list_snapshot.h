@@ -0,0 +1,193 @@
+
+#ifndef SKIP_LIST_SNAPSHOT_GUARD
+#define SKIP_LIST_SNAPSHOT_GUARD 1
+
+#include "./std_lib_facilities.h"
+#include "./tower_skip_list.h"
+#include "../file_handler/file_handle.h"
+#include<cstdint>
+#include<cstring>		// for memcmp(), memcpy()
+#include<type_traits>
+#include<algorithm>		// for lower_bound()
+#include<sys/mman.h>		// for mmap() (POSIX)
+#include<sys/stat.h>		// for fstat() (POSIX)
+
+// Saving a Tower_skip_list<T> to a binary file, and loading it back.
+// Rebuilding a list by insert() of every key takes a search from the top for each key, so
+// a snapshot stores the keys in ascending order, which is all that is needed to rebuild the
+// list in 1 linear pass by assign_sorted(), and optionally the height of each node, so that
+// the rebuilt list has exactly the same shape.
+// The file is:
+//   Snapshot_header (24 bytes)
+//   count keys of T, as they are in memory (so T must be trivially copyable)
+//   count heights of 1 byte each, if flags has Snapshot_header::has_heights
+// The numbers are written in the byte order of the machine, so a file is not portable
+// between little-endian and big-endian machines (the magic number catches that).
+// The keys start at byte 24, so the file can also be mmap()ed and the keys used in place
+// as a sorted array (see Skip_list_snapshot<T>), without building anything.
+struct Snapshot_header {
+  char magic[4];		// "SKPL"
+  uint32_t version;
+  uint32_t key_bytes;		// sizeof(T), to catch loading a file with another T
+  uint32_t flags;
+  uint64_t count;		// the number of keys
+
+  static constexpr uint32_t current_version{1};
+  static constexpr uint32_t has_heights{1};
+};
+static_assert(sizeof(Snapshot_header) == 24, "Snapshot_header must be 24 bytes without padding");
+
+// the size of the buffer of the file, and of the pieces in which the keys of the list (which
+// are not contiguous) are copied and written
+constexpr size_t snapshot_io_bytes{1<<16};
+
+// check the header of a snapshot of file_bytes bytes for keys of key_bytes bytes
+inline void check_snapshot_header(const Snapshot_header& h, size_t key_bytes, size_t file_bytes){
+  if(memcmp(h.magic, "SKPL", 4) != 0)
+    error("Error in reading a skip list snapshot. It is not a snapshot file.");
+  if(h.version != Snapshot_header::current_version)
+    error("Error in reading a skip list snapshot. Unknown version.");
+  if(h.key_bytes != key_bytes)
+    error("Error in reading a skip list snapshot. The key type is different.");
+  // a file of a later version may add flags, which this version would misread
+  if((h.flags & ~Snapshot_header::has_heights) != 0)
+    error("Error in reading a skip list snapshot. Unknown flags.");
+  // count*bytes_per_key can wrap around with a corrupt count and match the file size by
+  // chance, so count is checked by a division first, and only then the size is exact
+  size_t bytes_per_key{key_bytes + ((h.flags & Snapshot_header::has_heights)? 1 : 0)};
+  if(file_bytes < sizeof(Snapshot_header)
+     || h.count > (file_bytes - sizeof(Snapshot_header))/bytes_per_key
+     || file_bytes != sizeof(Snapshot_header) + h.count*bytes_per_key)
+    error("Error in reading a skip list snapshot. The file size doesn't match the header (the file may be truncated).");
+}
+
+inline size_t file_bytes_of(const File_handle& fh){
+  struct stat st;
+  if(fstat(fh.fileno(), &st) != 0)
+    error("Error in reading a skip list snapshot. Cannot get the file size.");
+  return static_cast<size_t>(st.st_size);
+}
+
+// write the keys of lst (and their heights if with_heights) to the file fn
+template<typename T>
+void save_snapshot(const Tower_skip_list<T>& lst, const string& fn, bool with_heights = true){
+  static_assert(is_trivially_copyable<T>::value, "a snapshot stores the bytes of the keys");
+  File_handle fh{fn, "wb", snapshot_io_bytes};
+  Snapshot_header h{{'S','K','P','L'}, Snapshot_header::current_version,
+      static_cast<uint32_t>(sizeof(T)), with_heights? Snapshot_header::has_heights : 0,
+      static_cast<uint64_t>(lst.size())};
+  fh.write_all(&h, sizeof(h));
+
+  // the keys are copied to a buffer and written piece by piece, since the nodes are not
+  // contiguous
+  vector<T> buf;
+  buf.reserve(snapshot_io_bytes/sizeof(T) + 1);
+  for(const T& k : lst){
+    buf.push_back(k);
+    if(buf.size()*sizeof(T) >= snapshot_io_bytes){
+      fh.write_all(buf.data(), buf.size()*sizeof(T));
+      buf.clear();
+    }
+  }
+  fh.write_all(buf.data(), buf.size()*sizeof(T));
+  if(with_heights){
+    vector<unsigned char> hs;
+    hs.reserve(snapshot_io_bytes);
+    for(auto p = lst.begin(); p!=lst.end(); ++p){
+      hs.push_back(static_cast<unsigned char>(p.height()));
+      if(hs.size() == snapshot_io_bytes){
+	fh.write_all(hs.data(), hs.size());
+	hs.clear();
+      }
+    }
+    fh.write_all(hs.data(), hs.size());
+  }
+}
+
+// replace the keys of lst with the keys in the file fn, in 1 linear pass. If the file has
+// the heights, the list gets the same shape as the saved one. Otherwise the heights are
+// drawn at random
+template<typename T>
+void load_snapshot(Tower_skip_list<T>& lst, const string& fn, int num_threads = 1){
+  static_assert(is_trivially_copyable<T>::value, "a snapshot stores the bytes of the keys");
+  File_handle fh{fn, "rb", snapshot_io_bytes};
+  size_t file_bytes{file_bytes_of(fh)};
+  if(file_bytes < sizeof(Snapshot_header))
+    error("Error in reading a skip list snapshot. The file is too short.");
+  Snapshot_header h;
+  fh.read_exact(&h, sizeof(h));
+  check_snapshot_header(h, sizeof(T), file_bytes);
+
+  vector<T> keys(h.count);
+  fh.read_exact(keys.data(), keys.size()*sizeof(T));
+  if(h.flags & Snapshot_header::has_heights){
+    vector<unsigned char> heights(h.count);
+    fh.read_exact(heights.data(), heights.size());
+    lst.assign_sorted(keys.begin(), keys.end(), move(heights), num_threads);
+  }
+  else
+    lst.assign_sorted(keys.begin(), keys.end(), true, num_threads);
+}
+
+// A read-only view of a snapshot file, mmap()ed into memory. Opening it reads nothing but
+// the header: the pages of the keys are read by the OS when they are first touched, so
+// lookups can start right away. The keys are a sorted array, so find() is a binary search
+// over them.
+template<typename T>
+class Skip_list_snapshot {
+public:
+  explicit Skip_list_snapshot(const string& fn);
+  ~Skip_list_snapshot(){munmap(base, bytes);}
+  Skip_list_snapshot(const Skip_list_snapshot&) = delete;
+  Skip_list_snapshot& operator=(const Skip_list_snapshot&) = delete;
+
+  size_t size() const {return n;}
+  const T* begin() const {return keys;}
+  const T* end() const {return keys + n;}
+  const T& operator[](size_t i) const {return keys[i];}
+  const T* find(const T& k) const; // pointer to the key equal to k, or nullptr
+  bool contains(const T& k) const {return find(k) != nullptr;}
+
+private:
+  void* base;			// the start of the mapping
+  size_t bytes;			// the size of the mapping (the file size)
+  const T* keys;
+  size_t n;
+};
+
+template<typename T>
+Skip_list_snapshot<T>::Skip_list_snapshot(const string& fn)
+  : base{nullptr}, bytes{0}, keys{nullptr}, n{0}
+{
+  static_assert(is_trivially_copyable<T>::value, "a snapshot stores the bytes of the keys");
+  static_assert(alignof(T) <= 8, "the keys start at byte 24 of the file");
+  File_handle fh{fn, "rb"};
+  bytes = file_bytes_of(fh);
+  if(bytes < sizeof(Snapshot_header))
+    error("Error in reading a skip list snapshot. The file is too short.");
+  base = mmap(nullptr, bytes, PROT_READ, MAP_PRIVATE, fh.fileno(), 0);
+  // the mapping stays valid after the file is closed by fh's destructor
+  if(base == MAP_FAILED)
+    error("Error in reading a skip list snapshot. mmap() failed.");
+  Snapshot_header h;
+  memcpy(&h, base, sizeof(h));
+  try{
+    check_snapshot_header(h, sizeof(T), bytes);
+  }
+  catch(...){
+    munmap(base, bytes);	// the destructor is not called when the constructor throws
+    throw;
+  }
+  keys = reinterpret_cast<const T*>(static_cast<const char*>(base) + sizeof(Snapshot_header));
+  n = h.count;
+}
+
+template<typename T>
+const T* Skip_list_snapshot<T>::find(const T& k) const {
+  const T* p{lower_bound(keys, keys+n, k)};
+  if(p == keys+n || k < *p)
+    return nullptr;
+  return p;
+}
+
+#endif // SKIP_LIST_SNAPSHOT_GUARD
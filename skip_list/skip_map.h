@@ -0,0 +1,244 @@
+
+#ifndef SKIP_MAP_GUARD
+#define SKIP_MAP_GUARD 1
+
+#include "./std_lib_facilities.h"
+#include "./tower_skip_list.h"	// for Node_pool<Node>
+#include "./level_generator.h"
+#include<utility>		// for pair
+
+// A node of SkipMap<K,V>. The same layout as Skip_node<T> in tower_skip_list.h, except that
+// the key is stored with its value, like the elements of std::map.
+template<typename K, typename V>
+struct Map_node {
+  pair<const K, V> kv;
+  int height;
+  Map_node* forward[1];		// "height" pointers are allocated (see Skip_node<T>)
+
+  Map_node(const K& k, const V& v, int h) : kv{k, v}, height{h} {}
+
+  static size_t bytes(int h){return sizeof(Map_node) + (h-1)*sizeof(Map_node*);}
+};
+
+// An ordered map on a skip list, with a subset of std::map's interface.
+// The map owns its head and all the nodes (taken from a Node_pool), so the user only deals
+// with keys and values, unlike Skip_list<T> where the user makes each node and passes the head.
+// The maximum height is derived from the expected size, as in Tower_skip_list<T>.
+template<typename K, typename V>
+class SkipMap : private Skip_list_base {
+public:
+  using key_type = K;
+  using mapped_type = V;
+  using value_type = pair<const K, V>;
+  using size_type = size_t;
+  using Node = Map_node<K,V>;
+  using Skip_list_base::max_levels;
+
+  explicit SkipMap(size_t expected_size = 1<<20, double p = 1/2.0);
+  ~SkipMap(){clear(); ::operator delete(head);}
+  SkipMap(const SkipMap&) = delete;
+  SkipMap& operator=(const SkipMap&) = delete;
+
+  class iterator;
+  class const_iterator;
+  iterator begin(){return iterator(head->forward[0]);}
+  iterator end(){return iterator(nullptr);}
+  const_iterator begin() const {return const_iterator(head->forward[0]);}
+  const_iterator end() const {return const_iterator(nullptr);}
+
+  size_type size() const {return sz;}
+  bool empty() const {return sz == 0;}
+  void seed(uint64_t s){levels.seed(s);} // see Tower_skip_list<T>::seed()
+
+  pair<iterator,bool> insert(const K& k, const V& v);
+  // insert (k,v) if k is not in the map. Otherwise, the map is not changed. In both cases,
+  // the returned iterator points to the element with key k, as std::map::insert()
+  V& operator[](const K& k);	// insert (k, V()) if k is not in the map
+  size_type erase(const K& k);	// the number of erased elements (0 or 1)
+  void clear();
+
+  iterator find(const K& k);	// end() if k is not in the map
+  const_iterator find(const K& k) const;
+  iterator lower_bound(const K& k); // the 1st element with key >= k
+  const_iterator lower_bound(const K& k) const;
+  bool contains(const K& k) const {return find(k) != end();}
+
+  // call f(key, value) for each element with key in [lo, hi), in ascending order
+  template<typename F>
+  void scan(const K& lo, const K& hi, F f) const;
+
+private:
+  int level;			// the number of levels in use
+  size_t sz;
+  Node* head;			// only its tower is used. Its kv is never constructed
+  Node_pool<Node> pool;
+  Level_generator levels;	// draws the heights of new nodes
+
+  int random_height();
+  void raise_max_height();
+  Node* find_update(const K& k, Node** update) const; // see Tower_skip_list<T>
+  Node* lower_bound_node(const K& k) const;
+};
+
+template<typename K, typename V>
+class SkipMap<K,V>::iterator {
+public:
+  explicit iterator(Node* p) : curr{p} {}
+  iterator& operator++(){curr = curr->forward[0]; return *this;}
+  value_type& operator*() const {return curr->kv;}
+  value_type* operator->() const {return &curr->kv;}
+  bool operator==(const iterator& b) const {return curr==b.curr;}
+  bool operator!=(const iterator& b) const {return curr!=b.curr;}
+private:
+  Node* curr;
+  friend class const_iterator;
+};
+
+template<typename K, typename V>
+class SkipMap<K,V>::const_iterator {
+public:
+  explicit const_iterator(const Node* p) : curr{p} {}
+  const_iterator(const iterator& it) : curr{it.curr} {} // iterator -> const_iterator
+  const_iterator& operator++(){curr = curr->forward[0]; return *this;}
+  const value_type& operator*() const {return curr->kv;}
+  const value_type* operator->() const {return &curr->kv;}
+  bool operator==(const const_iterator& b) const {return curr==b.curr;}
+  bool operator!=(const const_iterator& b) const {return curr!=b.curr;}
+private:
+  const Node* curr;
+};
+
+template<typename K, typename V>
+SkipMap<K,V>::SkipMap(size_t expected_size, double p)
+  : Skip_list_base{expected_size, p, "a SkipMap"}, level{1}, sz{0}, head{nullptr}
+{
+  levels.set_probability(prob);
+  head = new_head(&Node::forward, nullptr, Heap_head<Node>{});
+}
+
+template<typename K, typename V>
+void SkipMap<K,V>::clear(){
+  free_nodes(head, pool);
+  level = 1;
+  sz = 0;
+}
+
+template<typename K, typename V>
+int SkipMap<K,V>::random_height(){
+  return levels(max_h);
+}
+
+template<typename K, typename V>
+void SkipMap<K,V>::raise_max_height(){
+  grow_head(head, &Node::forward, nullptr, Heap_head<Node>{}, Heap_head<Node>{});
+}
+
+template<typename K, typename V>
+typename SkipMap<K,V>::Node* SkipMap<K,V>::find_update(const K& k, Node** update) const {
+  Node* p{head};
+  for(int i=level-1; i>-1; --i){
+    while(p->forward[i]!=nullptr && p->forward[i]->kv.first < k)
+      p = p->forward[i];
+    update[i] = p;
+  }
+  return p;
+}
+
+template<typename K, typename V>
+typename SkipMap<K,V>::Node* SkipMap<K,V>::lower_bound_node(const K& k) const {
+  Node* p{head};
+  for(int i=level-1; i>-1; --i){
+    while(p->forward[i]!=nullptr && p->forward[i]->kv.first < k)
+      p = p->forward[i];
+  }
+  return p->forward[0];
+}
+
+template<typename K, typename V>
+pair<typename SkipMap<K,V>::iterator, bool> SkipMap<K,V>::insert(const K& k, const V& v){
+  if(sz >= capacity)
+    raise_max_height();
+
+  Node* update[max_levels];
+  Node* p{find_update(k, update)->forward[0]};
+  if(p != nullptr && !(k < p->kv.first))
+    return {iterator(p), false};
+
+  int h{random_height()};
+  if(h > level){
+    for(int i=level; i<h; ++i)
+      update[i] = head;
+    level = h;
+  }
+
+  Node* n{new(pool.allocate(h)) Node(k, v, h)};
+  for(int i=0; i<h; ++i){
+    n->forward[i] = update[i]->forward[i];
+    update[i]->forward[i] = n;
+  }
+  ++sz;
+  return {iterator(n), true};
+}
+
+template<typename K, typename V>
+V& SkipMap<K,V>::operator[](const K& k){
+  Node* p{lower_bound_node(k)};
+  if(p != nullptr && !(k < p->kv.first))
+    return p->kv.second;
+  return insert(k, V{}).first->second;
+}
+
+template<typename K, typename V>
+typename SkipMap<K,V>::size_type SkipMap<K,V>::erase(const K& k){
+  Node* update[max_levels];
+  Node* p{find_update(k, update)->forward[0]};
+  if(p == nullptr || k < p->kv.first)
+    return 0;
+
+  for(int i=0; i<p->height; ++i)
+    update[i]->forward[i] = p->forward[i];
+  while(level > 1 && head->forward[level-1] == nullptr)
+    --level;
+
+  int h{p->height};
+  p->~Node();
+  pool.deallocate(p, h);
+  --sz;
+  return 1;
+}
+
+template<typename K, typename V>
+typename SkipMap<K,V>::iterator SkipMap<K,V>::find(const K& k){
+  Node* p{lower_bound_node(k)};
+  if(p == nullptr || k < p->kv.first)
+    return end();
+  return iterator(p);
+}
+
+template<typename K, typename V>
+typename SkipMap<K,V>::const_iterator SkipMap<K,V>::find(const K& k) const {
+  const Node* p{lower_bound_node(k)};
+  if(p == nullptr || k < p->kv.first)
+    return end();
+  return const_iterator(p);
+}
+
+template<typename K, typename V>
+typename SkipMap<K,V>::iterator SkipMap<K,V>::lower_bound(const K& k){
+  return iterator(lower_bound_node(k));
+}
+
+template<typename K, typename V>
+typename SkipMap<K,V>::const_iterator SkipMap<K,V>::lower_bound(const K& k) const {
+  return const_iterator(lower_bound_node(k));
+}
+
+template<typename K, typename V>
+template<typename F>
+void SkipMap<K,V>::scan(const K& lo, const K& hi, F f) const {
+  // 1 search for lo, and then just walk level 0
+  for(const Node* p{lower_bound_node(lo)}; p!=nullptr && p->kv.first < hi; p=p->forward[0])
+    f(p->kv.first, p->kv.second);
+}
+
+#endif // SKIP_MAP_GUARD
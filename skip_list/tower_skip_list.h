@@ -0,0 +1,623 @@
+
+#ifndef TOWER_SKIP_LIST_GUARD
+#define TOWER_SKIP_LIST_GUARD 1
+
+#include "./std_lib_facilities.h"
+#include "./level_generator.h"
+#include<new>			// for placement new
+#include<thread>		// for assign_sorted() with threads
+
+// A node of Tower_skip_list<T>.
+// In Skip_list<T>, forward_ptr points to another array allocated by new[], so moving forward
+// at a level reads 2 blocks of memory (node -> forward_ptr array -> next node). Here the tower
+// of forward pointers is allocated in the same block, right after the key, so it reads only
+// node -> next node, and the key and the lower pointers are usually in the same cache line.
+template<typename T>
+struct Skip_node {
+  T key;
+  int height;			// the number of forward pointers in the tower
+  Skip_node* forward[1];
+  // Only forward[0] is declared, but the block of a node is allocated with room for
+  // "height" pointers (see bytes()), so forward[0] ... forward[height-1] can be used.
+  // This is the so-called "struct hack", the C++ version of C's flexible array member.
+
+  Skip_node(const T& k, int h) : key{k}, height{h} {}
+
+  // byte size of the block of a node with height h
+  static size_t bytes(int h){return sizeof(Skip_node) + (h-1)*sizeof(Skip_node*);}
+};
+
+// Node_pool<Node> hands out the memory blocks of nodes.
+// Instead of calling new for each node, it cuts blocks out of big chunks, and keeps freed
+// blocks in a free list for each height, so that the block of an erased node is reused by the
+// next node with the same height. All the chunks are freed at once in the destructor.
+// Node must have static size_t bytes(int height), which is the size of its block.
+// Like allocator<T>, it only deals with memory. Construction/destruction of nodes is done by
+// the user of the pool.
+template<typename Node>
+class Node_pool {
+public:
+  explicit Node_pool(size_t chunk_b = 1<<20)
+    : chunk_bytes{chunk_b}, next{nullptr}, left{0}
+  {}
+  ~Node_pool(){
+    for(char* c : chunks)
+      ::operator delete(c);
+  }
+  // A pool owns memory blocks that nodes of a skip list point to, so copying a pool makes
+  // no sense
+  Node_pool(const Node_pool&) = delete;
+  Node_pool& operator=(const Node_pool&) = delete;
+
+  void* allocate(int h){
+    if(h < static_cast<int>(free_lists.size()) && free_lists[h] != nullptr){
+      // reuse a freed block. The 1st bytes of a freed block hold the next freed block
+      void* p{free_lists[h]};
+      free_lists[h] = *static_cast<void**>(p);
+      return p;
+    }
+    size_t n{round_up(Node::bytes(h))};
+    if(n > left){
+      // the rest of the current chunk is too small. It is just left unused
+      size_t sz{(n > chunk_bytes)? n : chunk_bytes};
+      // ::operator new() aligns only for the fundamental types (16 bytes). A Node declared
+      // with a larger alignas(), e.g. a cache line, needs some room to align the 1st block
+      size_t extra{(alignof(Node) > alignof(max_align_t))? alignof(Node) : 0};
+      chunks.push_back(static_cast<char*>(::operator new(sz + extra)));
+      next = chunks.back();
+      if(extra > 0)
+	next += (alignof(Node) - reinterpret_cast<uintptr_t>(next) % alignof(Node)) % alignof(Node);
+      left = sz;
+    }
+    void* p{next};
+    next += n;
+    left -= n;
+    return p;
+  }
+
+  // 1 block of b bytes, for many nodes at once (see Tower_skip_list<T>::assign_sorted()).
+  // It becomes a chunk of its own. The nodes in it can be deallocated one by one as usual
+  void* allocate_block(size_t b){
+    chunks.push_back(static_cast<char*>(::operator new(b)));
+    return chunks.back();
+  }
+  // the bytes allocate(h) takes out of a chunk
+  static size_t block_bytes(int h){return round_up(Node::bytes(h));}
+
+  void deallocate(void* p, int h){
+    if(h >= static_cast<int>(free_lists.size()))
+      free_lists.resize(h+1, nullptr);
+    *static_cast<void**>(p) = free_lists[h];
+    free_lists[h] = p;
+  }
+
+private:
+  size_t chunk_bytes;		// size of a chunk
+  vector<char*> chunks;		// all the chunks allocated so far
+  char* next;			// the next free byte in the last chunk
+  size_t left;			// the number of free bytes left in the last chunk
+  vector<void*> free_lists;	// free_lists[h] is the 1st freed block for height h
+
+  // each block must start at an address aligned for Node
+  static size_t round_up(size_t n){
+    return (n + alignof(Node) - 1) / alignof(Node) * alignof(Node);
+  }
+};
+
+// The maximum height of the skip lists here (Tower_skip_list<T>, SkipMap<K,V>,
+// Indexable_skip_list<T>, Block_skip_list<T>, and Concurrent_skip_list<T>), which they inherit
+// privately. max_h is derived from the expected number of keys (or blocks), and when a list
+// outgrows capacity, its raise_max_height() calls grow_head() to add 1 level to its head.
+// The tower of a node is named differently in each list (forward, link, next), so the
+// functions on the head take a pointer to it as a member, e.g. &Node::forward, and index it
+// as a plain pointer (a Link[1] indexed beyond [0] is the struct hack of Skip_node<T>).
+class Skip_list_base {
+public:
+  static constexpr int max_levels{64};	// upper limit of max_h
+
+protected:
+  double prob;			// probability of promoting another level
+  int max_h;			// cap of the height of a node, log_{1/p}(expected size)
+  size_t capacity;		// the number of keys max_h is good for, (1/p)^max_h
+
+  // what is the list in the error message, e.g. "a SkipMap"
+  Skip_list_base(size_t expected_size, double p, const char* what)
+    : prob{p}, max_h{1}, capacity{1}
+  {
+    if(prob<0 || prob>=1)
+      error(string("Error in initializing ") + what
+	    + " object. The probability must be in [0,1).");
+    // max_h = log_{1/p}(expected_size) = log(expected_size)/log(1/p), at least 1.
+    // If p==0, no node is promoted, so the height 1 is enough
+    if(prob > 0 && expected_size > 1){
+      max_h = static_cast<int>(ceil(log(double(expected_size)) / log(1/prob)));
+      if(max_h < 1) max_h = 1;
+      if(max_h > max_levels) max_h = max_levels;
+    }
+    capacity = keys_for(prob, max_h);
+  }
+
+  // (1/p)^h, the number of keys the height h is good for. With p==0, it is infinite
+  static size_t keys_for(double p, int h){
+    double c{pow(1/p, h)};
+    return (c < 1e18)? static_cast<size_t>(c) : static_cast<size_t>(-1);
+  }
+
+  // a head with a tower of max_h links, each set to empty. Its block is alloc(max_h)
+  template<typename Node, typename Link, typename Empty, typename Alloc>
+  Node* new_head(Link (Node::*tower)[1], const Empty& empty, Alloc alloc) const {
+    Node* h{static_cast<Node*>(alloc(max_h))};
+    Link* t{h->*tower};
+    for(int i=0; i<max_h; ++i)
+      t[i] = empty;
+    return h;
+  }
+
+  // move the tower of head to a block of alloc(max_h+1), with top as the new top link, give
+  // the old block to release(head, max_h), and raise max_h by 1. false (and nothing is done)
+  // if max_h is already max_levels
+  template<typename Node, typename Link, typename Top, typename Alloc, typename Release>
+  bool grow_head(Node*& head, Link (Node::*tower)[1], const Top& top, Alloc alloc,
+		 Release release){
+    if(max_h == max_levels)
+      return false;
+    Node* h{static_cast<Node*>(alloc(max_h+1))};
+    Link* t{h->*tower};
+    const Link* old{head->*tower};
+    for(int i=0; i<max_h; ++i)
+      t[i] = old[i];
+    t[max_h] = top;
+    release(head, max_h);
+    head = h;
+    ++max_h;
+    capacity = keys_for(prob, max_h);
+    return true;
+  }
+
+  // destroy the nodes after head, which have forward and height as Skip_node<T>, give their
+  // blocks back to pool, and make the tower of head empty
+  template<typename Node>
+  void free_nodes(Node* head, Node_pool<Node>& pool) const {
+    Node* p{head->forward[0]};
+    while(p != nullptr){
+      Node* p2{p->forward[0]};
+      int h{p->height};
+      p->~Node();
+      pool.deallocate(p, h);
+      p = p2;
+    }
+    for(int i=0; i<max_h; ++i)
+      head->forward[i] = nullptr;
+  }
+
+  // the allocation of a head by ::operator new(), for new_head() and grow_head()
+  template<typename Node>
+  struct Heap_head {
+    void* operator()(int h) const {return ::operator new(Node::bytes(h));}
+    void operator()(Node* p, int) const {::operator delete(p);}
+  };
+};
+
+// A skip list that owns its nodes, which have the layout of Skip_node<T>, and which come from
+// a Node_pool. Unlike Skip_list<T>, a key is given to insert()/erase() instead of a node, and
+// the same key is stored only once (like std::set).
+// The maximum height is derived from the expected number of keys n, as log_{1/p}(n), instead
+// of the fixed 1000 of Skip_list<T>. When the number of keys exceeds what that height is good
+// for, the maximum height is raised by 1, so the expected size is just a hint.
+template<typename T>
+class Tower_skip_list : private Skip_list_base {
+public:
+  using Node = Skip_node<T>;
+  using Skip_list_base::max_levels;	// upper limit of max_height()
+
+  explicit Tower_skip_list(size_t expected_size = 1<<20, double p = 1/2.0);
+  ~Tower_skip_list();
+  // Copying would need to copy all the nodes, and it's not needed for now, so it is disabled
+  Tower_skip_list(const Tower_skip_list&) = delete;
+  Tower_skip_list& operator=(const Tower_skip_list&) = delete;
+
+  bool insert(const T& k);	// false if k is already in the list
+  bool erase(const T& k);	// false if k is not in the list
+  void clear();
+
+  // Replace the keys with the keys in [first, last), which must be sorted in strictly
+  // ascending order. Instead of insert() for each key, which searches from the top every
+  // time, the towers are linked from left to right in O(n).
+  // random_heights: draw the heights as insert() does. Otherwise the heights are
+  // deterministic and perfectly balanced: every (1/p)-th node has height >= 2, every
+  // (1/p)^2-th node has height >= 3, and so on.
+  // num_threads > 1: the range is cut into that many segments, which are built by their own
+  // threads, and then the segments are stitched together at each level.
+  template<typename Ran>
+  void assign_sorted(Ran first, Ran last, bool random_heights = true, int num_threads = 1);
+  // the same, with the height of each node given, e.g. the heights saved in a snapshot
+  // (see skip_list_snapshot.h). Heights above max_height() are cut down to it
+  template<typename Ran>
+  void assign_sorted(Ran first, Ran last, vector<unsigned char> heights, int num_threads = 1);
+  const T* find(const T& k) const; // pointer to the key equal to k, or nullptr
+  const T* search(const T& k) const;
+  // the largest key <= k, like Skip_list<T>::search(), or nullptr if every key is > k
+  bool contains(const T& k) const {return find(k) != nullptr;}
+
+  // A Finger remembers the search path (the last node whose key < k at each level) of the
+  // last find(k, finger). The next find() with the same finger starts from that path
+  // instead of the top of head: it climbs up only as high as it needs to go past the keys
+  // in between, and then goes down. So searching keys in ascending order costs O(log d) per
+  // key, where d is the distance from the previous key, and m sorted keys in a list of n
+  // keys cost O(m log(n/m)) instead of O(m log n).
+  // A smaller key than the previous one, or any change of the list after the last search,
+  // just makes the next search start from head again.
+  class Finger {
+  public:
+    Finger() : owner{nullptr}, version{0} {}
+  private:
+    const Tower_skip_list* owner;
+    size_t version;		// owner->version at the last search
+    const Node* path[max_levels];
+    friend class Tower_skip_list;
+  };
+  const T* find(const T& k, Finger& f) const;
+
+  // For each key in the range [first, last), write the pointer to the equal key in the list
+  // (or nullptr) to result, and return the end of the output. It is fastest when the keys
+  // are sorted in ascending order, since 1 Finger is used for the whole batch.
+  template<typename In, typename Out>
+  Out find_sorted(In first, In last, Out result) const;
+
+  size_t size() const {return sz;}
+  int max_height() const {return max_h;}
+  size_t memory_bytes() const;	// bytes of the nodes in use and of head
+  void seed(uint64_t s){levels.seed(s);} // the same seed gives the same heights
+  void display() const;		// display each level for debug
+
+  // iterates over the keys in ascending order (level 0)
+  class const_iterator {
+  public:
+    explicit const_iterator(const Node* p) : curr{p} {}
+    const_iterator& operator++(){curr = curr->forward[0]; return *this;}
+    const T& operator*() const {return curr->key;}
+    const T* operator->() const {return &curr->key;}
+    int height() const {return curr->height;} // the height of the node of this key
+    bool operator==(const const_iterator& b) const {return curr==b.curr;}
+    bool operator!=(const const_iterator& b) const {return curr!=b.curr;}
+  private:
+    const Node* curr;
+  };
+  const_iterator begin() const {return const_iterator(head->forward[0]);}
+  const_iterator end() const {return const_iterator(nullptr);}
+
+private:
+  int level;			// the number of levels in use (the same as head.height in
+				// Skip_list<T>::insert())
+  size_t sz;			// the number of keys
+  size_t version;		// changed on every change of the links, for Finger
+  Node* head;
+  // Only the tower of head is used. head's key is never constructed, so T doesn't need a
+  // minimum value (see my comment in Skip_list<T>'s constructor), or a default constructor
+  Node_pool<Node> pool;
+  Level_generator levels;	// draws the heights of new nodes
+
+  int random_height();
+  void raise_max_height();	// max_h+1, and re-allocate head with a taller tower
+  // fill update[i] with the last node whose key < k at level i, and return update[0]
+  Node* find_update(const T& k, Node** update) const;
+
+  // the first and the last node of a segment at each level, in assign_sorted()
+  struct Segment {
+    Node* first_at[max_levels];
+    Node* last_at[max_levels];
+  };
+};
+
+template<typename T>
+Tower_skip_list<T>::Tower_skip_list(size_t expected_size, double p)
+  : Skip_list_base{expected_size, p, "a Tower_skip_list"}, level{1}, sz{0}, version{0},
+    head{nullptr}
+{
+  levels.set_probability(prob);
+  head = new_head(&Node::forward, nullptr, Heap_head<Node>{});
+}
+
+template<typename T>
+Tower_skip_list<T>::~Tower_skip_list(){
+  // destroy the keys. The memory of the nodes is freed all at once by pool's destructor
+  Node* p{head->forward[0]};
+  while(p != nullptr){
+    Node* p2{p->forward[0]};
+    p->~Node();
+    p = p2;
+  }
+  ::operator delete(head);
+}
+
+template<typename T>
+int Tower_skip_list<T>::random_height(){
+  return levels(max_h);
+}
+
+template<typename T>
+void Tower_skip_list<T>::raise_max_height(){
+  if(grow_head(head, &Node::forward, nullptr, Heap_head<Node>{}, Heap_head<Node>{}))
+    ++version;
+}
+
+template<typename T>
+typename Tower_skip_list<T>::Node* Tower_skip_list<T>::find_update(const T& k,
+								    Node** update) const {
+  Node* p{head};
+  for(int i=level-1; i>-1; --i){
+    while(p->forward[i]!=nullptr && p->forward[i]->key < k)
+      p = p->forward[i];
+    update[i] = p;
+  }
+  return p;
+}
+
+template<typename T>
+bool Tower_skip_list<T>::insert(const T& k){
+  if(sz >= capacity)
+    raise_max_height();
+
+  Node* update[max_levels];
+  Node* p{find_update(k, update)->forward[0]};
+  if(p != nullptr && !(k < p->key)) // p->key >= k, so !(k < p->key) means p->key == k
+    return false;
+
+  int h{random_height()};
+  if(h > level){
+    // the levels above the current top are reached only from head
+    for(int i=level; i<h; ++i)
+      update[i] = head;
+    level = h;
+  }
+
+  Node* n{new(pool.allocate(h)) Node(k, h)};
+  for(int i=0; i<h; ++i){
+    n->forward[i] = update[i]->forward[i];
+    update[i]->forward[i] = n;
+  }
+  ++sz;
+  ++version;
+  return true;
+}
+
+template<typename T>
+bool Tower_skip_list<T>::erase(const T& k){
+  Node* update[max_levels];
+  Node* p{find_update(k, update)->forward[0]};
+  if(p == nullptr || k < p->key)
+    return false;
+
+  // update[i]->forward[i] == p for all the levels of p's tower
+  for(int i=0; i<p->height; ++i)
+    update[i]->forward[i] = p->forward[i];
+  while(level > 1 && head->forward[level-1] == nullptr)
+    --level;
+
+  int h{p->height};
+  p->~Node();
+  pool.deallocate(p, h);
+  --sz;
+  ++version;
+  return true;
+}
+
+template<typename T>
+void Tower_skip_list<T>::clear(){
+  free_nodes(head, pool);
+  level = 1;
+  sz = 0;
+  ++version;
+}
+
+template<typename T>
+template<typename Ran>
+void Tower_skip_list<T>::assign_sorted(Ran first, Ran last, bool random_heights,
+				       int num_threads){
+  size_t n{static_cast<size_t>(last - first)};
+  while(n > capacity && max_h < max_levels)
+    raise_max_height();
+
+  // The heights are decided first, so that the byte size of each segment is known before
+  // building it. A height is <= 64, so 1 byte is enough
+  vector<unsigned char> heights(n);
+  if(random_heights){
+    for(size_t i=0; i<n; ++i)
+      heights[i] = static_cast<unsigned char>(levels(max_h));
+  }
+  else{
+    // the (i+1)-th node gets 1 level for each factor b in i+1, where b is 1/p rounded
+    size_t b{(prob > 0)? static_cast<size_t>(llround(1/prob)) : 0};
+    for(size_t i=0; i<n; ++i){
+      int h{1};
+      for(size_t j{i+1}; b >= 2 && h < max_h && j%b == 0; j /= b)
+	++h;
+      heights[i] = static_cast<unsigned char>(h);
+    }
+  }
+  assign_sorted(first, last, move(heights), num_threads);
+}
+
+template<typename T>
+template<typename Ran>
+void Tower_skip_list<T>::assign_sorted(Ran first, Ran last, vector<unsigned char> heights,
+				       int num_threads){
+  if(num_threads < 1)
+    error("Error in Tower_skip_list::assign_sorted(). The number of threads must be >= 1.");
+  size_t n{static_cast<size_t>(last - first)};
+  if(heights.size() != n)
+    error("Error in Tower_skip_list::assign_sorted(). The number of heights must be the same as the number of keys.");
+  for(size_t i=1; i<n; ++i)
+    if(!(first[i-1] < first[i]))
+      error("Error in Tower_skip_list::assign_sorted(). The keys must be sorted in strictly ascending order.");
+
+  clear();
+  if(n == 0)
+    return;
+  while(n > capacity && max_h < max_levels)
+    raise_max_height();
+  for(unsigned char& h : heights){
+    if(h < 1) h = 1;
+    if(h > max_h) h = static_cast<unsigned char>(max_h);
+  }
+
+  // segment s is [seg_begin[s], seg_begin[s+1]), and its nodes take seg_bytes[s] bytes
+  size_t num_segs{(static_cast<size_t>(num_threads) < n)? static_cast<size_t>(num_threads) : n};
+  vector<size_t> seg_begin(num_segs+1);
+  vector<size_t> seg_bytes(num_segs, 0);
+  for(size_t s=0; s<=num_segs; ++s)
+    seg_begin[s] = n*s/num_segs;
+  size_t total{0};
+  for(size_t s=0; s<num_segs; ++s){
+    for(size_t i=seg_begin[s]; i<seg_begin[s+1]; ++i)
+      seg_bytes[s] += Node_pool<Node>::block_bytes(heights[i]);
+    total += seg_bytes[s];
+  }
+  // all the nodes in 1 block, which also puts them in key order in memory
+  char* block{static_cast<char*>(pool.allocate_block(total))};
+
+  vector<Segment> segs(num_segs);
+  auto build = [&](size_t s){
+    char* p{block};
+    for(size_t t=0; t<s; ++t)
+      p += seg_bytes[t];
+    Segment& seg{segs[s]};
+    for(int l=0; l<max_h; ++l)
+      seg.first_at[l] = seg.last_at[l] = nullptr;
+    for(size_t i=seg_begin[s]; i<seg_begin[s+1]; ++i){
+      int h{heights[i]};
+      Node* nd{new(p) Node(first[i], h)};
+      for(int l=0; l<h; ++l){
+	if(seg.last_at[l] == nullptr)
+	  seg.first_at[l] = nd;
+	else
+	  seg.last_at[l]->forward[l] = nd;
+	seg.last_at[l] = nd;
+	nd->forward[l] = nullptr;
+      }
+      p += Node_pool<Node>::block_bytes(h);
+    }
+  };
+  if(num_segs == 1)
+    build(0);
+  else{
+    vector<thread> threads;
+    for(size_t s=0; s<num_segs; ++s)
+      threads.push_back(thread(build, s));
+    for(thread& th : threads)
+      th.join();
+  }
+
+  // stitch: at each level, the last node of the segments so far points to the first node of
+  // the next segment that has that level
+  Node* prev[max_levels];
+  for(int l=0; l<max_h; ++l)
+    prev[l] = head;
+  for(const Segment& seg : segs)
+    for(int l=0; l<max_h; ++l)
+      if(seg.first_at[l] != nullptr){
+	prev[l]->forward[l] = seg.first_at[l];
+	prev[l] = seg.last_at[l];
+      }
+
+  level = 1;
+  for(int l=max_h-1; l>0; --l)
+    if(head->forward[l] != nullptr){
+      level = l+1;
+      break;
+    }
+  sz = n;
+  ++version;
+}
+
+template<typename T>
+const T* Tower_skip_list<T>::find(const T& k) const {
+  const Node* p{head};
+  for(int i=level-1; i>-1; --i){
+    while(p->forward[i]!=nullptr && p->forward[i]->key < k)
+      p = p->forward[i];
+  }
+  p = p->forward[0];
+  if(p == nullptr || k < p->key)
+    return nullptr;
+  return &p->key;
+}
+
+template<typename T>
+const T* Tower_skip_list<T>::find(const T& k, Finger& f) const {
+  const Node* p;
+  int i;
+  // Every path[l] has a key < the previous key (or is head). If k is not smaller than
+  // path[0]'s key, the path is still valid for k, since the keys of path[l] are in
+  // ascending order as l goes down
+  if(f.owner == this && f.version == version && (f.path[0] == head || f.path[0]->key < k)){
+    // climb up while the next node at the level above is still < k
+    i = 0;
+    while(i+1 < level && f.path[i+1]->forward[i+1] != nullptr
+	  && f.path[i+1]->forward[i+1]->key < k)
+      ++i;
+    p = f.path[i];
+  }
+  else{
+    f.owner = this;
+    f.version = version;
+    for(int l=0; l<level; ++l)
+      f.path[l] = head;
+    i = level-1;
+    p = head;
+  }
+  for(; i>-1; --i){
+    while(p->forward[i]!=nullptr && p->forward[i]->key < k)
+      p = p->forward[i];
+    f.path[i] = p;
+  }
+  p = p->forward[0];
+  if(p == nullptr || k < p->key)
+    return nullptr;
+  return &p->key;
+}
+
+template<typename T>
+template<typename In, typename Out>
+Out Tower_skip_list<T>::find_sorted(In first, In last, Out result) const {
+  Finger f;
+  for(; first!=last; ++first)
+    *result++ = find(*first, f);
+  return result;
+}
+
+template<typename T>
+const T* Tower_skip_list<T>::search(const T& k) const {
+  // the same as Skip_list<T>::search(), with < changed to <= to include the key equal to k
+  const Node* p{head};
+  for(int i=level-1; i>-1; --i){
+    while(p->forward[i]!=nullptr && !(k < p->forward[i]->key))
+      p = p->forward[i];
+  }
+  if(p == head)
+    return nullptr;
+  return &p->key;
+}
+
+template<typename T>
+size_t Tower_skip_list<T>::memory_bytes() const {
+  size_t b{Node::bytes(max_h)};
+  for(const Node* p{head->forward[0]}; p!=nullptr; p=p->forward[0])
+    b += Node_pool<Node>::block_bytes(p->height);
+  return b;
+}
+
+template<typename T>
+void Tower_skip_list<T>::display() const {
+  for(int i=0; i<level; ++i){
+    cout << "level " << i << ": head -> ";
+    const Node* p{head->forward[i]};
+    while(p!=nullptr){
+      cout << p->key << " -> ";
+      p = p->forward[i];
+    }
+    cout << "null\n";
+  }
+}
+
+#endif // TOWER_SKIP_LIST_GUARD